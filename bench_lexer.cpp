@@ -0,0 +1,57 @@
+#include "lexer.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// 生成约 size 字节、由代码生成器风格的长表达式
+std::string makeExpression(size_t size) {
+    std::string expression = "0";
+    unsigned int seed = 42;
+    while (expression.size() < size) {
+        seed = seed * 1103515245u + 12345u;
+        int i = static_cast<int>((seed >> 16) % 1000);
+        expression += "    + coefficient_" + std::to_string(i) + " * sqrt(x_" + std::to_string(i % 17) +
+                      " + " + std::to_string(i) + ".125)\n";
+    }
+    return expression;
+}
+
+template <typename Function>
+double bestSeconds(int runs, Function function) {
+    double best = 1e9;
+    for (int run = 0; run < runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    return best;
+}
+
+int main() {
+    const std::string input = makeExpression(8 * 1024 * 1024);
+    const double gigabytes = static_cast<double>(input.size()) / 1e9;
+    std::cout << "Input: " << input.size() << " bytes" << std::endl;
+    
+    // 只扫描令牌，不保存
+    size_t scanned = 0;
+    double scan = bestSeconds(3, [&]() {
+        Lexer lexer(input);
+        scanned = 0;
+        while (lexer.getNextToken().type != TokenType::END) {
+            scanned++;
+        }
+    });
+    // 完整词法分析：令牌存入 vector
+    size_t tokens = 0;
+    double tokenize = bestSeconds(3, [&]() {
+        Lexer lexer(input);
+        tokens = lexer.tokenize().size() - 1;
+    });
+    
+    std::cout << "getNextToken loop:  " << gigabytes / scan << " GB/s, " << scanned << " tokens" << std::endl;
+    std::cout << "tokenize:           " << gigabytes / tokenize << " GB/s, " << tokens << " tokens" << std::endl;
+    
+    return scanned == tokens ? 0 : 1;
+}
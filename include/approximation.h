@@ -0,0 +1,48 @@
+#pragma once
+#include "program.h"
+#include <memory>
+#include <vector>
+
+// 单变量表达式在 [lower, upper] 上的分段 Chebyshev 逼近。
+// 区间被等分为若干段，每段用同一次数的 Chebyshev 级数表示，
+// 求值只需一次定位与 degree 次 Clenshaw 乘加；区间外的输入回退到精确计算。
+class Approximation {
+private:
+    double lower;
+    double upper;
+    double scale;  // pieces / (upper - lower)
+    size_t pieces;
+    int degree;
+    std::vector<double> coefficients;  // pieces 组，每组 degree + 1 个系数
+    std::shared_ptr<const Program> exact;
+    double achieved_error;
+    double tolerance;
+    
+    friend class ApproximationBuilder;
+    Approximation(std::shared_ptr<const Program> program, double lo, double hi, double tol);
+    
+public:
+    double operator()(double x) const;
+    // 批量求值
+    void evaluate(const double* x, double* results, size_t n) const;
+    // 精确求值（编译后的表达式）
+    double evaluateExact(double x) const;
+    
+    // 在校验网格上实测的最大绝对误差
+    double achievedError() const { return achieved_error; }
+    bool meetsTolerance() const { return achieved_error <= tolerance; }
+    size_t pieceCount() const { return pieces; }
+    int polynomialDegree() const { return degree; }
+    // 系数总数 pieces * (degree + 1)，即逼近表的大小
+    size_t coefficientCount() const { return coefficients.size(); }
+    double lowerBound() const { return lower; }
+    double upperBound() const { return upper; }
+};
+
+// 逼近的搜索范围：每个次数下分段数从 1 倍增到上限
+constexpr int APPROXIMATION_DEGREES[] = {4, 8, 12, 16};
+constexpr size_t APPROXIMATION_MAX_PIECES = 4096;
+
+// 为 program（唯一输入为自变量）构造满足 tolerance 的逼近，满足的候选中选择系数总数最少的
+// （相同时选次数较低的）；无法满足时返回搜索到的误差最小的逼近，meetsTolerance() 为 false
+Approximation buildApproximation(std::shared_ptr<const Program> program, double lo, double hi, double tolerance);
@@ -1,6 +1,8 @@
 #pragma once
 #include "lexer.h"
 #include "parser.h"
+#include "approximation.h"
+#include "profiler.h"
 #include <string>
 #include <locale>
 #include <memory>
@@ -21,6 +23,7 @@ private:
     // 缓存最后解析的AST以避免重复解析相同表达式
     mutable std::string last_expression;
     mutable std::unique_ptr<ASTNode> cached_ast;
+    mutable bool cached_integer_only = false;  // cached_ast 是否适用 int64 精确路径
     
 public:
     double evaluate(const std::string& expression);
@@ -28,6 +31,13 @@ public:
     void run(); // 交互式运行
     void clearCache(); // 清空缓存
     
+    // 剖析模式：重复求值 iterations 次，记录每个节点的调用次数与累计耗时
+    ProfileReport profile(const std::string& expression, size_t iterations = 1000);
+    
+    // 单变量逼近：在 [lo, hi] 上构造误差不超过 tolerance 的分段 Chebyshev 逼近
+    Approximation approximate(const std::string& expression, const std::string& variable,
+                              double lo, double hi, double tolerance);
+    
     // 性能统计
     struct Statistics {
         size_t expressions_evaluated = 0;
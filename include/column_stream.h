@@ -0,0 +1,64 @@
+#pragma once
+#include "program.h"
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 列数据源：按块读取若干命名列
+class ColumnSource {
+public:
+    virtual ~ColumnSource() = default;
+    virtual const std::vector<std::string>& columnNames() const = 0;
+    
+    // 读取至多 max_rows 行，columns[k] 被覆盖为第 k 列的数据，返回实际读取的行数（0 表示结束）
+    virtual size_t readChunk(std::vector<std::vector<double>>& columns, size_t max_rows) = 0;
+};
+
+// CSV 数据源：首行为列名，其余每行为逗号分隔的数值
+class CsvColumnSource : public ColumnSource {
+private:
+    std::istream& input;
+    std::vector<std::string> names;
+    std::string line;
+    size_t line_number = 0;
+    
+public:
+    CsvColumnSource(std::istream& in);
+    const std::vector<std::string>& columnNames() const override { return names; }
+    size_t readChunk(std::vector<std::vector<double>>& columns, size_t max_rows) override;
+};
+
+// 二进制数据源：按行连续存放的小端 float64 记录，每条记录依次包含各列的值
+class BinaryColumnSource : public ColumnSource {
+private:
+    std::istream& input;
+    std::vector<std::string> names;
+    std::vector<char> buffer;
+    
+public:
+    BinaryColumnSource(std::istream& in, const std::vector<std::string>& column_names);
+    const std::vector<std::string>& columnNames() const override { return names; }
+    size_t readChunk(std::vector<std::vector<double>>& columns, size_t max_rows) override;
+};
+
+// 结果列输出格式
+enum class ColumnOutputFormat {
+    TEXT,    // 每行一个数值（最短可往返表示）
+    BINARY   // 小端 float64
+};
+
+// 每块行数的上限：每列每块占用 chunk_rows * 8 字节，上限时约 128 MB
+constexpr size_t MAX_COLUMN_CHUNK_ROWS = static_cast<size_t>(1) << 24;
+
+// 流式列计算：逐块读取数据源，将列名绑定到表达式变量，按块批量计算并写出结果列。
+// 内存占用只取决于 chunk_rows，与数据量无关。返回处理的总行数。
+size_t evaluateColumns(const std::string& expression, ColumnSource& source,
+                       std::ostream& output, ColumnOutputFormat format,
+                       size_t chunk_rows = 65536);
+
+// 同上，使用已编译的单输出程序（例如从持久缓存中取出的程序）
+size_t evaluateColumns(const Program& program, ColumnSource& source,
+                       std::ostream& output, ColumnOutputFormat format,
+                       size_t chunk_rows = 65536);
@@ -0,0 +1,7 @@
+#pragma once
+#include "parser.h"
+#include "program.h"
+#include <string>
+
+// 解析表达式、执行优化改写并编译到构建器中，返回结果寄存器
+int compileExpression(ProgramBuilder& builder, const std::string& expression);
@@ -0,0 +1,37 @@
+#pragma once
+#include "program.h"
+#include <string>
+#include <vector>
+
+// 公式组：把一组共享输入的公式编译成一个程序，
+// 相同的子表达式在所有公式间只计算一次，所有结果在一趟计算中写出
+class FormulaBundle {
+private:
+    std::vector<std::string> formulas;
+    Program program;
+    size_t shared_count = 0;
+    
+    void compile(ProgramBuilder& builder);
+    
+public:
+    // 输入变量按首次出现的顺序排列
+    explicit FormulaBundle(const std::vector<std::string>& formulas);
+    // 指定输入变量顺序，公式引用其他变量时抛出异常
+    FormulaBundle(const std::vector<std::string>& formulas, const std::vector<std::string>& inputs);
+    
+    const std::vector<std::string>& variables() const { return program.inputNames(); }
+    size_t formulaCount() const { return formulas.size(); }
+    const Program& getProgram() const { return program; }
+    
+    // 编译统计
+    size_t instructionCount() const { return program.instructions().size(); }
+    size_t sharedSubexpressions() const { return shared_count; }
+    
+    // 单行计算：inputs 按 variables() 顺序排列，outputs 按公式顺序写出
+    void evaluate(const double* inputs, double* outputs) const;
+    std::vector<double> evaluate(const std::vector<double>& inputs) const;
+    
+    // 按列批量计算
+    void evaluateBatch(const double* const* input_columns, size_t rows,
+                       double* const* output_columns) const;
+};
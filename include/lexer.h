@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 
 // 令牌类型枚举
@@ -12,6 +13,24 @@ enum class TokenType {
     POWER,        // ^
     LEFT_PAREN,   // (
     RIGHT_PAREN,  // )
+    // 比较、逻辑与条件运算
+    LESS,          // <
+    LESS_EQUAL,    // <=
+    GREATER,       // >
+    GREATER_EQUAL, // >=
+    EQUAL,         // ==
+    NOT_EQUAL,     // !=
+    AND,           // &&
+    OR,            // ||
+    QUESTION,      // ?
+    COLON,         // :
+    COMMA,         // ,
+    IF,            // if
+    // 区间归约
+    SUM,           // sum
+    PROD,          // prod
+    MIN,           // min
+    MAX,           // max
     // 新增数学函数
     SQRT,         // sqrt
     SIN,          // sin
@@ -19,6 +38,7 @@ enum class TokenType {
     TAN,          // tan
     LOG,          // log
     EXP,          // exp
+    IDENTIFIER,   // 变量名
     END,          // 结束标记
     INVALID       // 无效令牌
 };
@@ -26,13 +46,16 @@ enum class TokenType {
 // 令牌结构体
 struct Token {
     TokenType type;
-    double value;      // 对于数字令牌存储值
-    std::string text;  // 原始文本
+    double value;           // 对于数字令牌存储值
+    std::string_view text;  // 原始文本，指向 Lexer 持有的输入，Lexer 销毁后失效
     
-    Token(TokenType t, double v = 0.0, const std::string& txt = "")
+    Token(TokenType t, double v = 0.0, std::string_view txt = {})
         : type(t), value(v), text(txt) {}
 };
 
+// 令牌类型对应的源码符号（用于诊断输出）
+const char* tokenSymbol(TokenType type);
+
 // 词法分析器类
 class Lexer {
 private:
@@ -44,9 +67,11 @@ private:
     void advance();
     void skipWhitespace();
     double readNumber();
-    std::string readIdentifier(); // 新增：读取标识符
+    std::string_view readIdentifier(); // 新增：读取标识符
+    bool nextIsLeftParen() const; // 跳过空白后下一个字符是否为 '('
     
 public:
+    // 令牌文本引用 Lexer 内部的输入副本，令牌只能在 Lexer 存活期间使用
     Lexer(const std::string& input);
     Token getNextToken();
     std::vector<Token> tokenize();
@@ -0,0 +1,18 @@
+#pragma once
+#include "parser.h"
+#include <memory>
+
+// 改写为乘法链的最大整数指数，更大的指数与负指数仍使用 std::pow。
+// 乘法链每次乘法各舍入一次，n <= 4 时结果与 std::pow 相差不超过 2 ulp
+constexpr int MAX_INT_POWER_EXPONENT = 4;
+
+// 对AST执行强度削减改写，返回改写后的根节点：
+//   -c、+c（常量）                                -> 常量
+//   x^n（0 <= n <= MAX_INT_POWER_EXPONENT 的整数常量） -> 平方求幂乘法链
+//   x^0.5                                         -> sqrt(x)
+//   x / c（1/c 可精确表示的非零常量）               -> x * (1/c)
+std::unique_ptr<ASTNode> optimizeAST(std::unique_ptr<ASTNode> root);
+
+// 计算AST：integer_only（优化后 root.isIntegerOnly() 的结果）为真时先尝试 int64 精确路径，
+// 溢出时回退到 double 计算；否则直接按 double 计算
+double evaluateWithFastPath(ASTNode& root, bool integer_only);
@@ -1,12 +1,32 @@
 #pragma once
 #include "lexer.h"
 #include <memory>
+#include <string>
+
+class Program;
+class ProgramBuilder;
 
 // 抽象语法树节点基类
 class ASTNode {
 public:
     virtual ~ASTNode() = default;
     virtual double evaluate() = 0;
+    
+    // 优化改写：先改写子节点，再返回替代本节点的新节点（nullptr 表示保持不变）
+    virtual std::unique_ptr<ASTNode> optimize() { return nullptr; }
+    
+    // int64 精确计算路径：不适用或发生溢出时返回 false
+    virtual bool evaluateInteger(long long& result) const { (void)result; return false; }
+    // 整棵子树是否只含 int64 路径支持的运算，在优化后判断一次，决定是否尝试 evaluateInteger
+    virtual bool isIntegerOnly() const { return false; }
+    
+    // 编译为程序指令，返回结果寄存器
+    virtual int compile(ProgramBuilder& builder) const = 0;
+    
+    // 节点描述与子节点访问（用于剖析等通用遍历）
+    virtual std::string describe() const = 0;
+    virtual size_t childCount() const { return 0; }
+    virtual std::unique_ptr<ASTNode>& child(size_t index);
 };
 
 // 数字节点
@@ -17,6 +37,24 @@ private:
 public:
     NumberNode(double val) : value(val) {}
     double evaluate() override { return value; }
+    double getValue() const { return value; }
+    bool evaluateInteger(long long& result) const override;
+    bool isIntegerOnly() const override;
+    int compile(ProgramBuilder& builder) const override;
+    std::string describe() const override;
+};
+
+// 变量节点：只能在编译后的程序中绑定输入值
+class VariableNode : public ASTNode {
+private:
+    std::string name;
+    
+public:
+    VariableNode(const std::string& var_name) : name(var_name) {}
+    double evaluate() override;
+    const std::string& getName() const { return name; }
+    int compile(ProgramBuilder& builder) const override;
+    std::string describe() const override;
 };
 
 // 二元操作节点
@@ -28,9 +66,16 @@ private:
     
 public:
     BinaryOpNode(std::unique_ptr<ASTNode> l, TokenType op, std::unique_ptr<ASTNode> r)
-        : left(std::move(l)), operator_type(op), right(std::move(r)) {}
+        : left(std::move(l)), right(std::move(r)), operator_type(op) {}
     
     double evaluate() override;
+    std::unique_ptr<ASTNode> optimize() override;
+    bool evaluateInteger(long long& result) const override;
+    bool isIntegerOnly() const override;
+    int compile(ProgramBuilder& builder) const override;
+    std::string describe() const override;
+    size_t childCount() const override { return 2; }
+    std::unique_ptr<ASTNode>& child(size_t index) override;
 };
 
 // 一元操作节点
@@ -41,9 +86,16 @@ private:
     
 public:
     UnaryOpNode(TokenType op, std::unique_ptr<ASTNode> operand)
-        : operator_type(op), operand(std::move(operand)) {}
+        : operand(std::move(operand)), operator_type(op) {}
     
     double evaluate() override;
+    std::unique_ptr<ASTNode> optimize() override;
+    bool evaluateInteger(long long& result) const override;
+    bool isIntegerOnly() const override;
+    int compile(ProgramBuilder& builder) const override;
+    std::string describe() const override;
+    size_t childCount() const override { return 1; }
+    std::unique_ptr<ASTNode>& child(size_t index) override;
 };
 
 // 数学函数节点
@@ -57,6 +109,113 @@ public:
         : function_type(func_type), argument(std::move(arg)) {}
     
     double evaluate() override;
+    std::unique_ptr<ASTNode> optimize() override;
+    int compile(ProgramBuilder& builder) const override;
+    std::string describe() const override;
+    size_t childCount() const override { return 1; }
+    std::unique_ptr<ASTNode>& child(size_t index) override;
+};
+
+// 逻辑运算节点（&&、||），按短路方式求值，结果为 1 或 0
+class LogicalNode : public ASTNode {
+private:
+    std::unique_ptr<ASTNode> left;
+    std::unique_ptr<ASTNode> right;
+    TokenType operator_type;
+    
+public:
+    LogicalNode(std::unique_ptr<ASTNode> l, TokenType op, std::unique_ptr<ASTNode> r)
+        : left(std::move(l)), right(std::move(r)), operator_type(op) {}
+    
+    double evaluate() override;
+    std::unique_ptr<ASTNode> optimize() override;
+    bool evaluateInteger(long long& result) const override;
+    bool isIntegerOnly() const override;
+    int compile(ProgramBuilder& builder) const override;
+    std::string describe() const override;
+    size_t childCount() const override { return 2; }
+    std::unique_ptr<ASTNode>& child(size_t index) override;
+};
+
+// 条件节点（cond ? a : b 或 if(cond, a, b)），只计算被选中的分支
+class ConditionalNode : public ASTNode {
+private:
+    std::unique_ptr<ASTNode> condition;
+    std::unique_ptr<ASTNode> when_true;
+    std::unique_ptr<ASTNode> when_false;
+    
+public:
+    ConditionalNode(std::unique_ptr<ASTNode> cond, std::unique_ptr<ASTNode> a, std::unique_ptr<ASTNode> b)
+        : condition(std::move(cond)), when_true(std::move(a)), when_false(std::move(b)) {}
+    
+    double evaluate() override;
+    std::unique_ptr<ASTNode> optimize() override;
+    bool evaluateInteger(long long& result) const override;
+    bool isIntegerOnly() const override;
+    int compile(ProgramBuilder& builder) const override;
+    std::string describe() const override;
+    size_t childCount() const override { return 3; }
+    std::unique_ptr<ASTNode>& child(size_t index) override;
+};
+
+// 区间归约节点：sum/prod/min/max(i, lo, hi, body)。
+// body 只编译一次，区间按固定大小分块后由多个线程计算
+class ReductionNode : public ASTNode {
+private:
+    TokenType reduction_type;
+    std::string variable;
+    std::unique_ptr<ASTNode> lower;
+    std::unique_ptr<ASTNode> upper;
+    std::unique_ptr<ASTNode> body;
+    mutable std::shared_ptr<const Program> body_program;
+    
+    std::shared_ptr<const Program> bodyProgram() const;
+    
+public:
+    ReductionNode(TokenType type, const std::string& var, std::unique_ptr<ASTNode> lo,
+                  std::unique_ptr<ASTNode> hi, std::unique_ptr<ASTNode> b)
+        : reduction_type(type), variable(var), lower(std::move(lo)), upper(std::move(hi)), body(std::move(b)) {}
+    
+    double evaluate() override;
+    std::unique_ptr<ASTNode> optimize() override;
+    int compile(ProgramBuilder& builder) const override;
+    std::string describe() const override;
+    size_t childCount() const override { return 3; }
+    std::unique_ptr<ASTNode>& child(size_t index) override;
+};
+
+// 整数指数乘方节点（由优化器生成）：x^n 使用平方求幂的乘法链代替 std::pow
+class IntPowerNode : public ASTNode {
+private:
+    std::unique_ptr<ASTNode> base;
+    int exponent;  // 0 <= exponent <= MAX_INT_POWER_EXPONENT
+    
+public:
+    IntPowerNode(std::unique_ptr<ASTNode> b, int n)
+        : base(std::move(b)), exponent(n) {}
+    
+    double evaluate() override;
+    bool evaluateInteger(long long& result) const override;
+    bool isIntegerOnly() const override;
+    int compile(ProgramBuilder& builder) const override;
+    std::string describe() const override;
+    size_t childCount() const override { return 1; }
+    std::unique_ptr<ASTNode>& child(size_t index) override;
+};
+
+// 平方根乘方节点（由优化器生成）：x^0.5 使用 std::sqrt 代替 std::pow
+class SqrtPowerNode : public ASTNode {
+private:
+    std::unique_ptr<ASTNode> base;
+    
+public:
+    SqrtPowerNode(std::unique_ptr<ASTNode> b) : base(std::move(b)) {}
+    
+    double evaluate() override;
+    int compile(ProgramBuilder& builder) const override;
+    std::string describe() const override;
+    size_t childCount() const override { return 1; }
+    std::unique_ptr<ASTNode>& child(size_t index) override;
 };
 
 // 语法分析器类
@@ -70,6 +229,12 @@ private:
     void eat(TokenType expected_type);
     
     std::unique_ptr<ASTNode> expression();
+    std::unique_ptr<ASTNode> conditional();
+    std::unique_ptr<ASTNode> logicalOr();
+    std::unique_ptr<ASTNode> logicalAnd();
+    std::unique_ptr<ASTNode> equality();
+    std::unique_ptr<ASTNode> comparison();
+    std::unique_ptr<ASTNode> additive();
     std::unique_ptr<ASTNode> term();
     std::unique_ptr<ASTNode> factor();
     std::unique_ptr<ASTNode> power();
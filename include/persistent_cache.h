@@ -0,0 +1,58 @@
+#pragma once
+#include "program.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// 跨进程持久缓存：一个固定大小的内存映射文件，保存常量表达式的结果与编译后的程序。
+// 文件由开放寻址的槽表和环形记录区组成。多个进程可以无锁地并发读取和写入，
+// 写满后新记录覆盖最旧的记录（先进先出淘汰）。
+// 读取时通过校验和与写入位置的二次检查丢弃未写完或已被覆盖的记录，因此并发写入只会造成未命中，
+// 不会读到错误数据。仅在 POSIX 平台可用。
+class PersistentCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 16u << 20;
+    static constexpr size_t MIN_CAPACITY = 64u << 10;
+    
+    // 打开或创建缓存文件；capacity 只在新建文件时生效，已有文件沿用其大小。
+    // 无法打开、文件不是缓存文件或平台不支持时抛出异常
+    explicit PersistentCache(const std::string& path, size_t capacity = DEFAULT_CAPACITY);
+    ~PersistentCache();
+    
+    PersistentCache(const PersistentCache&) = delete;
+    PersistentCache& operator=(const PersistentCache&) = delete;
+    
+    // 常量表达式结果
+    bool lookupResult(const std::string& expression, double& value) const;
+    void storeResult(const std::string& expression, double value);
+    
+    // 编译后的程序（解析结果），未命中时返回 nullptr
+    std::shared_ptr<const Program> lookupProgram(const std::string& expression) const;
+    void storeProgram(const std::string& expression, const Program& program);
+    
+    size_t capacity() const { return mapped_size; }
+
+private:
+    enum class EntryKind : std::uint8_t {
+        RESULT = 1,
+        PROGRAM = 2
+    };
+    
+    struct Header;
+    struct Slot;
+    
+    void* mapping = nullptr;
+    size_t mapped_size = 0;
+    int fd = -1;
+    
+    Header* header = nullptr;
+    Slot* slots = nullptr;
+    size_t slot_mask = 0;
+    std::atomic<std::uint64_t>* data = nullptr;  // 环形记录区，按 8 字节字访问
+    size_t data_words = 0;
+    
+    bool lookup(EntryKind kind, const std::string& text, std::string& value) const;
+    void store(EntryKind kind, const std::string& text, const std::string& value);
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include "parser.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 剖析结果中的单个节点
+struct ProfileEntry {
+    std::string node;
+    std::uint64_t calls = 0;
+    std::uint64_t cycles = 0;       // 含子节点的累计耗时
+    std::uint64_t self_cycles = 0;  // 扣除子节点（及其计时开销）后的耗时
+    bool measured = true;           // 归约体编译为程序批量计算，其中的节点不计时
+    std::vector<ProfileEntry> children;
+};
+
+// 剖析报告：带耗时注释的表达式树
+struct ProfileReport {
+    ProfileEntry root;
+    size_t iterations = 0;
+    double result = 0.0;
+    std::string unit;  // "cycles"（时间戳计数器）或 "ns"
+    std::string path;  // 实际使用的求值路径："int64" 或 "double"，与普通求值相同；只统计这一条路径
+    
+    std::string toText() const;
+    std::string toJson() const;
+};
+
+// 剖析装饰节点：只在剖析模式下包裹原节点，记录调用次数与累计耗时。
+// 普通求值路径中不存在该节点，因此关闭剖析时没有任何额外开销。
+class ProfiledNode : public ASTNode {
+private:
+    std::unique_ptr<ASTNode> inner;
+    mutable std::uint64_t calls = 0;
+    mutable std::uint64_t cycles = 0;
+    
+public:
+    ProfiledNode(std::unique_ptr<ASTNode> node) : inner(std::move(node)) {}
+    
+    double evaluate() override;
+    bool evaluateInteger(long long& result) const override;
+    bool isIntegerOnly() const override { return inner->isIntegerOnly(); }
+    int compile(ProgramBuilder& builder) const override { return inner->compile(builder); }
+    std::string describe() const override { return inner->describe(); }
+    size_t childCount() const override { return inner->childCount(); }
+    std::unique_ptr<ASTNode>& child(size_t index) override { return inner->child(index); }
+    
+    std::uint64_t callCount() const { return calls; }
+    std::uint64_t cycleCount() const { return cycles; }
+};
+
+// 用剖析节点包裹整棵树；归约体编译为程序执行，不经过树节点，因此不包裹
+std::unique_ptr<ASTNode> instrumentAST(std::unique_ptr<ASTNode> root);
+
+// 从已包裹并求值过的树中汇总剖析结果
+ProfileEntry collectProfile(ASTNode& root);
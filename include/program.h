@@ -0,0 +1,149 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 编译后程序的操作码
+enum class OpCode : std::uint8_t {
+    CONST,     // 常量 imm
+    INPUT,     // 第 a 个输入变量
+    ADD,       // a + b
+    SUB,       // a - b
+    MUL,       // a * b
+    DIV,       // a / b
+    POW,       // pow(a, b)
+    POW_HALF,  // pow(a, 0.5)，用 sqrt 实现
+    NEG,       // -a
+    SQRT,      // sqrt(a)
+    SIN,       // sin(a)
+    COS,       // cos(a)
+    TAN,       // tan(a)
+    LOG,       // log(a)
+    EXP,       // exp(a)
+    LT,        // a < b ? 1 : 0
+    LE,        // a <= b ? 1 : 0
+    GT,        // a > b ? 1 : 0
+    GE,        // a >= b ? 1 : 0
+    EQ,        // a == b ? 1 : 0
+    NE,        // a != b ? 1 : 0
+    AND,       // (a != 0 && b != 0) ? 1 : 0，两侧都已计算
+    OR,        // (a != 0 || b != 0) ? 1 : 0，两侧都已计算
+    SELECT,    // a != 0 ? b : c，无分支选择
+    REDUCE     // 对索引区间 [a, b] 执行第 c 个归约
+};
+
+// 归约类型
+enum class ReductionKind : std::uint8_t {
+    SUM,
+    PROD,
+    MIN,
+    MAX
+};
+
+// 受检计算中的错误，与树求值器抛出的异常一一对应
+enum class EvalError : std::uint8_t {
+    NONE,
+    DIVISION_BY_ZERO,  // 除数为 0
+    NEGATIVE_SQRT,     // sqrt 的参数为负数
+    LOG_DOMAIN         // log 的参数不为正数
+};
+
+class Program;
+
+// 归约描述：body 的第 0 个输入为索引变量，其余输入依次取 outer 寄存器的值
+struct Reduction {
+    ReductionKind kind;
+    std::shared_ptr<const Program> body;
+    std::vector<int> outer;
+};
+
+// 单条指令（SSA 形式：第 i 条指令的结果即寄存器 i）
+struct Instruction {
+    OpCode op;
+    int a;
+    int b;
+    int c;
+    double imm;
+};
+
+// 指令读取的寄存器操作数个数
+int operandCount(OpCode op);
+
+// 编译后的表达式程序：由一条或多条表达式共享的线性指令序列。
+// 程序按 IEEE 754 语义计算（除零得到 inf、负数开方得到 NaN），不抛出计算异常；
+// 条件与逻辑运算的两侧都会计算，再以无分支的选择合并结果。
+class Program {
+private:
+    std::vector<Instruction> code;
+    std::vector<std::string> variables;
+    std::vector<int> outputs;
+    std::vector<Reduction> reductions;
+    
+    // 批量计算时每个寄存器复用的缓冲槽（-1 表示常量或输入，无需缓冲）
+    std::vector<int> slots;
+    int slot_count = 0;
+    
+    friend class ProgramBuilder;
+    void assignSlots();
+    void evaluateBlocks(const double* const* input_columns, size_t rows,
+                        double* const* output_columns, EvalError* row_errors) const;
+    
+public:
+    // 批量计算时每块处理的行数
+    static constexpr size_t BLOCK_SIZE = 256;
+    
+    const std::vector<Instruction>& instructions() const { return code; }
+    const std::vector<std::string>& inputNames() const { return variables; }
+    size_t outputCount() const { return outputs.size(); }
+    
+    // 单行计算：inputs 按 inputNames() 顺序排列，结果写入 outputs[0..outputCount())
+    void evaluate(const double* inputs, double* outputs) const;
+    
+    // 批量计算：input_columns[k] 为第 k 个输入列，output_columns[j] 为第 j 个输出列
+    void evaluateBatch(const double* const* input_columns, size_t rows,
+                       double* const* output_columns) const;
+    
+    // 受检批量计算：结果与 evaluateBatch 相同，另外按树求值器的规则为每行记录错误。
+    // 只有实际会被求值的分支（条件的选中分支、未被短路的逻辑运算右侧）中的错误才会记录；
+    // 一行中有多个错误时记录求值顺序上的第一个，多个输出时取第一个出错的输出。
+    void evaluateBatchChecked(const double* const* input_columns, size_t rows,
+                              double* const* output_columns, EvalError* row_errors) const;
+    
+    // 序列化为与平台字节序相同的二进制数据（含嵌套的归约体）
+    std::string serialize() const;
+    // 从 serialize() 的结果恢复程序；数据不完整或指令引用越界时抛出异常
+    static Program deserialize(const std::string& bytes);
+};
+
+// 程序构建器：对结构相同的子表达式做哈希合并（公共子表达式消除）
+class ProgramBuilder {
+private:
+    Program program;
+    std::unordered_map<std::string, int> input_index;
+    std::unordered_map<std::string, int> instruction_index;
+    size_t shared_count = 0;
+    bool fixed_inputs = false;
+    
+    int emit(const Instruction& instruction);
+    
+public:
+    ProgramBuilder() = default;
+    // 固定输入变量顺序，引用其他变量时抛出异常
+    explicit ProgramBuilder(const std::vector<std::string>& inputs);
+    
+    int constant(double value);
+    int input(const std::string& name);
+    int unary(OpCode op, int a);
+    int binary(OpCode op, int a, int b);
+    int select(int condition, int when_true, int when_false);
+    int reduce(ReductionKind kind, std::shared_ptr<const Program> body, int lo, int hi,
+               const std::vector<int>& outer);
+    void addOutput(int reg);
+    
+    // 被合并（复用已有指令）的计算子表达式数量，重复的常量与输入不计入
+    size_t sharedCount() const { return shared_count; }
+    Program build();
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include "program.h"
+
+// 归约的分块大小：区间按固定大小切块，分块方式与线程数无关，保证结果确定
+constexpr size_t REDUCTION_CHUNK = 4096;
+
+// 区间项数达到该值时才启用多线程
+constexpr size_t REDUCTION_PARALLEL_THRESHOLD = 4 * REDUCTION_CHUNK;
+
+// 对 i = lo, lo + 1, ..., <= hi 计算 body 并归约。
+// outer_values 依次对应 body 除索引外的其余输入。
+// 求和使用 Neumaier 补偿求和，各块部分和按块顺序合并，结果与线程数无关。
+// 空区间的结果为 sum = 0、prod = 1、min = +inf、max = -inf；区间端点非有限时结果为 NaN。
+// error 非空时按树求值器的规则检查除零与定义域错误（见 Program::evaluateBatchChecked），
+// 写入索引最小的出错项的错误，没有错误时写入 EvalError::NONE。
+double reduceRange(ReductionKind kind, const Program& body, double lo, double hi, const double* outer_values,
+                   EvalError* error = nullptr);
+
+// 设置归约使用的线程数，0 表示使用硬件并发数
+void setReductionThreads(unsigned int threads);
+unsigned int reductionThreads();
@@ -0,0 +1,166 @@
+#include "approximation.h"
+#include "calculator.h"
+#include "compiler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// 每段校验网格的点数（相对于次数的倍数）
+constexpr int VERIFY_FACTOR = 4;
+
+double clenshaw(const double* c, int degree, double t) {
+    double b1 = 0.0;
+    double b2 = 0.0;
+    for (int j = degree; j >= 1; j--) {
+        double b0 = 2.0 * t * b1 - b2 + c[j];
+        b2 = b1;
+        b1 = b0;
+    }
+    return t * b1 - b2 + c[0];
+}
+
+} // namespace
+
+// 构造器：采样、拟合与误差校验
+class ApproximationBuilder {
+public:
+    static Approximation fit(const std::shared_ptr<const Program>& program, double lo, double hi,
+                             double tolerance, int degree, size_t pieces) {
+        Approximation result(program, lo, hi, tolerance);
+        result.pieces = pieces;
+        result.degree = degree;
+        result.scale = static_cast<double>(pieces) / (hi - lo);
+        
+        const int nodes = degree + 1;
+        const double width = (hi - lo) / static_cast<double>(pieces);
+        
+        // 一次性批量计算所有段的 Chebyshev 节点
+        std::vector<double> x(pieces * nodes);
+        for (size_t k = 0; k < pieces; k++) {
+            double a = lo + width * static_cast<double>(k);
+            for (int m = 0; m < nodes; m++) {
+                double t = std::cos(PI * (m + 0.5) / nodes);
+                x[k * nodes + m] = a + (t + 1.0) * 0.5 * width;
+            }
+        }
+        std::vector<double> f = sample(*program, x);
+        
+        result.coefficients.assign(pieces * nodes, 0.0);
+        for (size_t k = 0; k < pieces; k++) {
+            double* c = &result.coefficients[k * nodes];
+            for (int j = 0; j < nodes; j++) {
+                double sum = 0.0;
+                for (int m = 0; m < nodes; m++) {
+                    sum += f[k * nodes + m] * std::cos(PI * j * (m + 0.5) / nodes);
+                }
+                c[j] = 2.0 * sum / nodes;
+            }
+            c[0] *= 0.5;
+        }
+        
+        // 在每段的等距网格（含端点）上校验误差
+        const int verify = VERIFY_FACTOR * nodes;
+        std::vector<double> grid(pieces * (verify + 1));
+        for (size_t k = 0; k < pieces; k++) {
+            double a = lo + width * static_cast<double>(k);
+            for (int m = 0; m <= verify; m++) {
+                grid[k * (verify + 1) + m] = std::min(hi, a + width * m / verify);
+            }
+        }
+        std::vector<double> exact = sample(*program, grid);
+        
+        double error = 0.0;
+        for (size_t i = 0; i < grid.size(); i++) {
+            double diff = std::fabs(result(grid[i]) - exact[i]);
+            if (!(diff <= error)) {
+                error = std::isnan(diff) ? std::numeric_limits<double>::infinity() : diff;
+            }
+        }
+        result.achieved_error = error;
+        return result;
+    }
+    
+private:
+    static std::vector<double> sample(const Program& program, const std::vector<double>& x) {
+        std::vector<double> values(x.size());
+        const double* inputs[] = {x.data()};
+        double* outputs[] = {values.data()};
+        program.evaluateBatch(inputs, x.size(), outputs);
+        return values;
+    }
+};
+
+Approximation::Approximation(std::shared_ptr<const Program> program, double lo, double hi, double tol)
+    : lower(lo), upper(hi), scale(0.0), pieces(0), degree(0), exact(std::move(program)),
+      achieved_error(std::numeric_limits<double>::infinity()), tolerance(tol) {
+}
+
+double Approximation::operator()(double x) const {
+    if (!(x >= lower && x <= upper)) {
+        return evaluateExact(x);
+    }
+    double u = (x - lower) * scale;
+    size_t k = std::min(static_cast<size_t>(u), pieces - 1);
+    double t = 2.0 * (u - static_cast<double>(k)) - 1.0;
+    return clenshaw(&coefficients[k * (degree + 1)], degree, t);
+}
+
+void Approximation::evaluate(const double* x, double* results, size_t n) const {
+    for (size_t i = 0; i < n; i++) {
+        results[i] = (*this)(x[i]);
+    }
+}
+
+double Approximation::evaluateExact(double x) const {
+    double result = 0.0;
+    exact->evaluate(&x, &result);
+    return result;
+}
+
+Approximation buildApproximation(std::shared_ptr<const Program> program, double lo, double hi, double tolerance) {
+    std::unique_ptr<Approximation> chosen;   // 满足容差且系数最少的候选
+    std::unique_ptr<Approximation> closest;  // 都不满足时返回误差最小的候选
+    
+    // 每个次数下取满足容差的最少分段；次数按升序尝试，系数相同时保留低次数
+    for (int degree : APPROXIMATION_DEGREES) {
+        for (size_t pieces = 1; pieces <= APPROXIMATION_MAX_PIECES; pieces *= 2) {
+            size_t count = pieces * static_cast<size_t>(degree + 1);
+            if (chosen && count >= chosen->coefficientCount()) {
+                break;  // 分段更多只会更大
+            }
+            Approximation candidate = ApproximationBuilder::fit(program, lo, hi, tolerance, degree, pieces);
+            if (candidate.meetsTolerance()) {
+                chosen = std::make_unique<Approximation>(std::move(candidate));
+                break;
+            }
+            if (!closest || candidate.achievedError() < closest->achievedError()) {
+                closest = std::make_unique<Approximation>(std::move(candidate));
+            }
+        }
+    }
+    return chosen ? std::move(*chosen) : std::move(*closest);
+}
+
+Approximation Calculator::approximate(const std::string& expression, const std::string& variable,
+                                      double lo, double hi, double tolerance) {
+    if (!std::isfinite(lo) || !std::isfinite(hi) || !(lo < hi)) {
+        throw CalculatorException("Calculation Error: 逼近区间无效");
+    }
+    if (!(tolerance > 0.0)) {
+        throw CalculatorException("Calculation Error: 误差容限必须为正数");
+    }
+    
+    try {
+        ProgramBuilder builder({variable});
+        builder.addOutput(compileExpression(builder, expression));
+        auto program = std::make_shared<const Program>(builder.build());
+        return buildApproximation(program, lo, hi, tolerance);
+    } catch (const std::exception& e) {
+        throw CalculatorException("Calculation Error: " + std::string(e.what()));
+    }
+}
@@ -1,4 +1,5 @@
 #include "calculator.h"
+#include "optimizer.h"
 #include <iostream>
 #include <stdexcept>
 #include <chrono>
@@ -10,7 +11,7 @@ double Calculator::evaluate(const std::string& expression) {
         // 检查缓存
         if (last_expression == expression && cached_ast) {
             stats.cache_hits++;
-            auto result = cached_ast->evaluate();
+            auto result = evaluateWithFastPath(*cached_ast, cached_integer_only);
             
             auto end_time = std::chrono::high_resolution_clock::now();
             auto duration = std::chrono::duration<double>(end_time - start_time).count();
@@ -28,12 +29,16 @@ double Calculator::evaluate(const std::string& expression) {
         Parser parser(tokens);
         auto ast = parser.parse();
         
+        // 强度削减优化
+        ast = optimizeAST(std::move(ast));
+        
         // 缓存AST
         last_expression = expression;
         cached_ast = std::move(ast);
+        cached_integer_only = cached_ast->isIntegerOnly();
         
-        // 计算结果
-        auto result = cached_ast->evaluate();
+        // 计算结果（整数表达式优先走 int64 精确路径）
+        auto result = evaluateWithFastPath(*cached_ast, cached_integer_only);
         
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration<double>(end_time - start_time).count();
@@ -49,6 +54,7 @@ double Calculator::evaluate(const std::string& expression) {
 void Calculator::clearCache() {
     last_expression.clear();
     cached_ast.reset();
+    cached_integer_only = false;
 }
 
 void Calculator::printHelp() const {
@@ -61,6 +67,10 @@ void Calculator::printHelp() const {
     std::cout << "  / : Division" << std::endl;
     std::cout << "  ^ : Power" << std::endl;
     std::cout << "  ( ) : Parentheses" << std::endl;
+    std::cout << "  < <= > >= == != : Comparison (1 or 0)" << std::endl;
+    std::cout << "  && || : Logical and/or (short-circuit)" << std::endl;
+    std::cout << "  c ? a : b, if(c, a, b) : Conditional" << std::endl;
+    std::cout << "  sum/prod/min/max(i, lo, hi, expr) : Reduction over i = lo..hi" << std::endl;
     std::cout << "\nExample expressions:" << std::endl;
     std::cout << "  2 + 3 * 4" << std::endl;
     std::cout << "  (2 + 3) * 4" << std::endl;
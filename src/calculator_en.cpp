@@ -1,4 +1,5 @@
 #include "calculator.h"
+#include "optimizer.h"
 #include <iostream>
 #include <stdexcept>
 
@@ -18,8 +19,11 @@ double Calculator::evaluate(const std::string& expression) {
         Parser parser(tokens);
         auto ast = parser.parse();
         
-        // 计算结果
-        return ast->evaluate();
+        // 强度削减优化
+        ast = optimizeAST(std::move(ast));
+        
+        // 计算结果（整数表达式优先走 int64 精确路径）
+        return evaluateWithFastPath(*ast, ast->isIntegerOnly());
     } catch (const std::exception& e) {
         throw CalculatorException("Calculation Error: " + std::string(e.what()));
     }
@@ -34,6 +38,10 @@ void Calculator::printHelp() const {
     std::cout << "  / : Division" << std::endl;
     std::cout << "  ^ : Power" << std::endl;
     std::cout << "  ( ) : Parentheses" << std::endl;
+    std::cout << "  < <= > >= == != : Comparison (1 or 0)" << std::endl;
+    std::cout << "  && || : Logical and/or (short-circuit)" << std::endl;
+    std::cout << "  c ? a : b, if(c, a, b) : Conditional" << std::endl;
+    std::cout << "  sum/prod/min/max(i, lo, hi, expr) : Reduction over i = lo..hi" << std::endl;
     std::cout << "\nExample expressions:" << std::endl;
     std::cout << "  2 + 3 * 4" << std::endl;
     std::cout << "  (2 + 3) * 4" << std::endl;
@@ -1,4 +1,5 @@
 #include "calculator.h"
+#include "optimizer.h"
 #include <iostream>
 #include <stdexcept>
 
@@ -16,8 +17,11 @@ double Calculator::evaluate(const std::string& expression) {
         Parser parser(tokens);
         auto ast = parser.parse();
         
-        // 计算结果
-        return ast->evaluate();
+        // 强度削减优化
+        ast = optimizeAST(std::move(ast));
+        
+        // 计算结果（整数表达式优先走 int64 精确路径）
+        return evaluateWithFastPath(*ast, ast->isIntegerOnly());
     } catch (const std::exception& e) {
         throw CalculatorException("计算错误：" + std::string(e.what()));
     }
@@ -32,6 +36,10 @@ void Calculator::printHelp() const {
     std::cout << "  / : 除法" << std::endl;
     std::cout << "  ^ : 乘方" << std::endl;
     std::cout << "  ( ) : 括号" << std::endl;
+    std::cout << "  < <= > >= == != : 比较（结果为 1 或 0）" << std::endl;
+    std::cout << "  && || : 逻辑与/或（短路求值）" << std::endl;
+    std::cout << "  c ? a : b, if(c, a, b) : 条件选择" << std::endl;
+    std::cout << "  sum/prod/min/max(i, lo, hi, expr) : 对 i = lo..hi 归约" << std::endl;
     std::cout << "\n支持的数学函数：" << std::endl;
     std::cout << "  sqrt(x) : 平方根" << std::endl;
     std::cout << "  sin(x)  : 正弦函数" << std::endl;
@@ -0,0 +1,189 @@
+#include "column_stream.h"
+#include "compiler.h"
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+bool isLittleEndian() {
+    const std::uint16_t probe = 1;
+    unsigned char first = 0;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+void byteSwap(char* bytes, size_t count) {
+    for (size_t i = 0; i < count; i += sizeof(double)) {
+        for (size_t j = 0; j < sizeof(double) / 2; j++) {
+            std::swap(bytes[i + j], bytes[i + sizeof(double) - 1 - j]);
+        }
+    }
+}
+
+} // namespace
+
+CsvColumnSource::CsvColumnSource(std::istream& in) : input(in) {
+    while (std::getline(input, line)) {
+        line_number++;
+        if (trim(line).empty()) {
+            continue;
+        }
+        size_t start = 0;
+        while (true) {
+            size_t comma = line.find(',', start);
+            names.push_back(trim(line.substr(start, comma - start)));
+            if (comma == std::string::npos) {
+                break;
+            }
+            start = comma + 1;
+        }
+        return;
+    }
+    throw std::runtime_error("CSV 文件缺少列名");
+}
+
+size_t CsvColumnSource::readChunk(std::vector<std::vector<double>>& columns, size_t max_rows) {
+    columns.resize(names.size());
+    for (auto& column : columns) {
+        column.resize(max_rows);
+    }
+    
+    size_t rows = 0;
+    while (rows < max_rows && std::getline(input, line)) {
+        line_number++;
+        if (trim(line).empty()) {
+            continue;
+        }
+        
+        const char* p = line.c_str();
+        for (size_t k = 0; k < names.size(); k++) {
+            char* end = nullptr;
+            double value = std::strtod(p, &end);
+            if (end == p) {
+                throw std::runtime_error("CSV 第 " + std::to_string(line_number) + " 行：无效的数值");
+            }
+            while (*end == ' ' || *end == '\t' || *end == '\r') {
+                end++;
+            }
+            bool last = k + 1 == names.size();
+            if ((last && *end != '\0') || (!last && *end != ',')) {
+                throw std::runtime_error("CSV 第 " + std::to_string(line_number) + " 行：列数不匹配");
+            }
+            columns[k][rows] = value;
+            p = last ? end : end + 1;
+        }
+        rows++;
+    }
+    return rows;
+}
+
+BinaryColumnSource::BinaryColumnSource(std::istream& in, const std::vector<std::string>& column_names)
+    : input(in), names(column_names) {
+    if (names.empty()) {
+        throw std::runtime_error("二进制列文件需要指定列名");
+    }
+}
+
+size_t BinaryColumnSource::readChunk(std::vector<std::vector<double>>& columns, size_t max_rows) {
+    const size_t record_size = names.size() * sizeof(double);
+    buffer.resize(max_rows * record_size);
+    input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    size_t bytes = static_cast<size_t>(input.gcount());
+    if (bytes % record_size != 0) {
+        throw std::runtime_error("二进制列文件长度不是记录大小的整数倍");
+    }
+    if (!isLittleEndian()) {
+        byteSwap(buffer.data(), bytes);
+    }
+    
+    // 按行记录转置为列
+    size_t rows = bytes / record_size;
+    columns.resize(names.size());
+    for (size_t k = 0; k < names.size(); k++) {
+        columns[k].resize(max_rows);
+        for (size_t i = 0; i < rows; i++) {
+            std::memcpy(&columns[k][i], buffer.data() + i * record_size + k * sizeof(double), sizeof(double));
+        }
+    }
+    return rows;
+}
+
+size_t evaluateColumns(const std::string& expression, ColumnSource& source,
+                       std::ostream& output, ColumnOutputFormat format,
+                       size_t chunk_rows) {
+    ProgramBuilder builder;
+    builder.addOutput(compileExpression(builder, expression));
+    return evaluateColumns(builder.build(), source, output, format, chunk_rows);
+}
+
+size_t evaluateColumns(const Program& program, ColumnSource& source,
+                       std::ostream& output, ColumnOutputFormat format,
+                       size_t chunk_rows) {
+    if (chunk_rows == 0 || chunk_rows > MAX_COLUMN_CHUNK_ROWS) {
+        throw std::runtime_error("块大小必须在 1 到 " + std::to_string(MAX_COLUMN_CHUNK_ROWS) + " 行之间");
+    }
+    if (program.outputCount() != 1) {
+        throw std::runtime_error("列计算要求程序只有一个输出");
+    }
+    
+    // 将表达式变量绑定到同名列
+    const auto& names = source.columnNames();
+    std::vector<size_t> binding;
+    for (const auto& variable : program.inputNames()) {
+        size_t k = 0;
+        while (k < names.size() && names[k] != variable) {
+            k++;
+        }
+        if (k == names.size()) {
+            throw std::runtime_error("数据中没有与变量对应的列：" + variable);
+        }
+        binding.push_back(k);
+    }
+    
+    std::vector<std::vector<double>> columns;
+    std::vector<const double*> inputs(binding.size());
+    std::vector<double> result(chunk_rows);
+    double* outputs[] = {result.data()};
+    std::string text;
+    size_t total = 0;
+    
+    while (size_t rows = source.readChunk(columns, chunk_rows)) {
+        for (size_t v = 0; v < binding.size(); v++) {
+            inputs[v] = columns[binding[v]].data();
+        }
+        program.evaluateBatch(inputs.data(), rows, outputs);
+        
+        if (format == ColumnOutputFormat::BINARY) {
+            if (!isLittleEndian()) {
+                byteSwap(reinterpret_cast<char*>(result.data()), rows * sizeof(double));
+            }
+            output.write(reinterpret_cast<const char*>(result.data()),
+                         static_cast<std::streamsize>(rows * sizeof(double)));
+        } else {
+            text.clear();
+            char number[32];
+            for (size_t i = 0; i < rows; i++) {
+                auto converted = std::to_chars(number, number + sizeof(number), result[i]);
+                text.append(number, converted.ptr);
+                text.push_back('\n');
+            }
+            output << text;
+        }
+        total += rows;
+    }
+    
+    output.flush();
+    return total;
+}
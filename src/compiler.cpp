@@ -0,0 +1,146 @@
+#include "compiler.h"
+#include "optimizer.h"
+#include <stdexcept>
+
+int compileExpression(ProgramBuilder& builder, const std::string& expression) {
+    Lexer lexer(expression);
+    auto tokens = lexer.tokenize();
+    
+    Parser parser(tokens);
+    auto ast = optimizeAST(parser.parse());
+    
+    return ast->compile(builder);
+}
+
+int NumberNode::compile(ProgramBuilder& builder) const {
+    return builder.constant(value);
+}
+
+int VariableNode::compile(ProgramBuilder& builder) const {
+    return builder.input(name);
+}
+
+int BinaryOpNode::compile(ProgramBuilder& builder) const {
+    int a = left->compile(builder);
+    int b = right->compile(builder);
+    
+    switch (operator_type) {
+        case TokenType::PLUS:          return builder.binary(OpCode::ADD, a, b);
+        case TokenType::MINUS:         return builder.binary(OpCode::SUB, a, b);
+        case TokenType::MULTIPLY:      return builder.binary(OpCode::MUL, a, b);
+        case TokenType::DIVIDE:        return builder.binary(OpCode::DIV, a, b);
+        case TokenType::POWER:         return builder.binary(OpCode::POW, a, b);
+        case TokenType::LESS:          return builder.binary(OpCode::LT, a, b);
+        case TokenType::LESS_EQUAL:    return builder.binary(OpCode::LE, a, b);
+        case TokenType::GREATER:       return builder.binary(OpCode::GT, a, b);
+        case TokenType::GREATER_EQUAL: return builder.binary(OpCode::GE, a, b);
+        case TokenType::EQUAL:         return builder.binary(OpCode::EQ, a, b);
+        case TokenType::NOT_EQUAL:     return builder.binary(OpCode::NE, a, b);
+        default:
+            throw std::runtime_error("未知的二元操作符");
+    }
+}
+
+int LogicalNode::compile(ProgramBuilder& builder) const {
+    int a = left->compile(builder);
+    int b = right->compile(builder);
+    
+    switch (operator_type) {
+        case TokenType::AND: return builder.binary(OpCode::AND, a, b);
+        case TokenType::OR:  return builder.binary(OpCode::OR, a, b);
+        default:
+            throw std::runtime_error("未知的逻辑操作符");
+    }
+}
+
+int ConditionalNode::compile(ProgramBuilder& builder) const {
+    int c = condition->compile(builder);
+    int a = when_true->compile(builder);
+    int b = when_false->compile(builder);
+    return builder.select(c, a, b);
+}
+
+int UnaryOpNode::compile(ProgramBuilder& builder) const {
+    int a = operand->compile(builder);
+    
+    switch (operator_type) {
+        case TokenType::PLUS:  return a;
+        case TokenType::MINUS: return builder.unary(OpCode::NEG, a);
+        default:
+            throw std::runtime_error("未知的一元操作符");
+    }
+}
+
+int FunctionNode::compile(ProgramBuilder& builder) const {
+    int a = argument->compile(builder);
+    
+    switch (function_type) {
+        case TokenType::SQRT: return builder.unary(OpCode::SQRT, a);
+        case TokenType::SIN:  return builder.unary(OpCode::SIN, a);
+        case TokenType::COS:  return builder.unary(OpCode::COS, a);
+        case TokenType::TAN:  return builder.unary(OpCode::TAN, a);
+        case TokenType::LOG:  return builder.unary(OpCode::LOG, a);
+        case TokenType::EXP:  return builder.unary(OpCode::EXP, a);
+        default:
+            throw std::runtime_error("未知的数学函数");
+    }
+}
+
+std::shared_ptr<const Program> ReductionNode::bodyProgram() const {
+    if (!body_program) {
+        // 索引变量固定为第 0 个输入，其余输入为外层变量
+        ProgramBuilder builder;
+        builder.input(variable);
+        builder.addOutput(body->compile(builder));
+        body_program = std::make_shared<const Program>(builder.build());
+    }
+    return body_program;
+}
+
+int ReductionNode::compile(ProgramBuilder& builder) const {
+    int lo = lower->compile(builder);
+    int hi = upper->compile(builder);
+    
+    std::shared_ptr<const Program> program = bodyProgram();
+    std::vector<int> outer;
+    const auto& names = program->inputNames();
+    for (size_t j = 1; j < names.size(); j++) {
+        outer.push_back(builder.input(names[j]));
+    }
+    
+    ReductionKind kind = ReductionKind::SUM;
+    switch (reduction_type) {
+        case TokenType::SUM:  kind = ReductionKind::SUM; break;
+        case TokenType::PROD: kind = ReductionKind::PROD; break;
+        case TokenType::MIN:  kind = ReductionKind::MIN; break;
+        case TokenType::MAX:  kind = ReductionKind::MAX; break;
+        default:
+            throw std::runtime_error("未知的归约操作");
+    }
+    return builder.reduce(kind, program, lo, hi, outer);
+}
+
+int IntPowerNode::compile(ProgramBuilder& builder) const {
+    int x = base->compile(builder);
+    
+    // 展开平方求幂：x^2、x^4 等中间结果同样参与公共子表达式合并
+    unsigned int n = static_cast<unsigned int>(exponent);
+    int result = -1;
+    while (n > 0) {
+        if (n & 1u) {
+            result = result < 0 ? x : builder.binary(OpCode::MUL, result, x);
+        }
+        n >>= 1;
+        if (n > 0) {
+            x = builder.binary(OpCode::MUL, x, x);
+        }
+    }
+    if (result < 0) {
+        return builder.constant(1.0);
+    }
+    return result;
+}
+
+int SqrtPowerNode::compile(ProgramBuilder& builder) const {
+    return builder.unary(OpCode::POW_HALF, base->compile(builder));
+}
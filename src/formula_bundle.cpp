@@ -0,0 +1,46 @@
+#include "formula_bundle.h"
+#include "calculator.h"
+#include "compiler.h"
+#include <stdexcept>
+
+FormulaBundle::FormulaBundle(const std::vector<std::string>& formulas) : formulas(formulas) {
+    ProgramBuilder builder;
+    compile(builder);
+}
+
+FormulaBundle::FormulaBundle(const std::vector<std::string>& formulas,
+                             const std::vector<std::string>& inputs) : formulas(formulas) {
+    ProgramBuilder builder(inputs);
+    compile(builder);
+}
+
+void FormulaBundle::compile(ProgramBuilder& builder) {
+    for (size_t i = 0; i < formulas.size(); i++) {
+        try {
+            builder.addOutput(compileExpression(builder, formulas[i]));
+        } catch (const std::exception& e) {
+            throw CalculatorException("Compilation Error in formula " + std::to_string(i + 1) +
+                                      ": " + std::string(e.what()));
+        }
+    }
+    shared_count = builder.sharedCount();
+    program = builder.build();
+}
+
+void FormulaBundle::evaluate(const double* inputs, double* outputs) const {
+    program.evaluate(inputs, outputs);
+}
+
+std::vector<double> FormulaBundle::evaluate(const std::vector<double>& inputs) const {
+    if (inputs.size() != program.inputNames().size()) {
+        throw CalculatorException("Calculation Error: 输入变量数量不匹配");
+    }
+    std::vector<double> outputs(formulas.size());
+    program.evaluate(inputs.data(), outputs.data());
+    return outputs;
+}
+
+void FormulaBundle::evaluateBatch(const double* const* input_columns, size_t rows,
+                                  double* const* output_columns) const {
+    program.evaluateBatch(input_columns, rows, output_columns);
+}
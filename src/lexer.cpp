@@ -1,7 +1,79 @@
 #include "lexer.h"
-#include <cctype>
+#include <charconv>
 #include <stdexcept>
 
+namespace {
+
+// ASCII 字符分类（与 "C" locale 下的 std::isspace 等一致，可内联且不受 locale 影响）
+inline bool isSpace(char ch) {
+    return ch == ' ' || (ch >= '\t' && ch <= '\r');
+}
+
+inline bool isDigit(char ch) {
+    return ch >= '0' && ch <= '9';
+}
+
+inline bool isAlpha(char ch) {
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+}
+
+inline bool isAlnum(char ch) {
+    return isDigit(ch) || isAlpha(ch);
+}
+
+// 解析只含数字和至多一个小数点的字面量，结果与 std::stod 一致（包括异常）
+double parseLiteral(const char* begin, const char* end) {
+    // 过长的字面量可能上溢或下溢，交给 std::stod 以保持相同的 out_of_range 异常
+    if (end - begin < 300) {
+        double value = 0.0;
+        auto parsed = std::from_chars(begin, end, value);
+        if (parsed.ec == std::errc() && parsed.ptr == end) {
+            return value;
+        }
+    }
+    return std::stod(std::string(begin, end));
+}
+
+} // namespace
+
+const char* tokenSymbol(TokenType type) {
+    switch (type) {
+        case TokenType::PLUS:          return "+";
+        case TokenType::MINUS:         return "-";
+        case TokenType::MULTIPLY:      return "*";
+        case TokenType::DIVIDE:        return "/";
+        case TokenType::POWER:         return "^";
+        case TokenType::LEFT_PAREN:    return "(";
+        case TokenType::RIGHT_PAREN:   return ")";
+        case TokenType::LESS:          return "<";
+        case TokenType::LESS_EQUAL:    return "<=";
+        case TokenType::GREATER:       return ">";
+        case TokenType::GREATER_EQUAL: return ">=";
+        case TokenType::EQUAL:         return "==";
+        case TokenType::NOT_EQUAL:     return "!=";
+        case TokenType::AND:           return "&&";
+        case TokenType::OR:            return "||";
+        case TokenType::QUESTION:      return "?";
+        case TokenType::COLON:         return ":";
+        case TokenType::COMMA:         return ",";
+        case TokenType::IF:            return "if";
+        case TokenType::SUM:           return "sum";
+        case TokenType::PROD:          return "prod";
+        case TokenType::MIN:           return "min";
+        case TokenType::MAX:           return "max";
+        case TokenType::SQRT:          return "sqrt";
+        case TokenType::SIN:           return "sin";
+        case TokenType::COS:           return "cos";
+        case TokenType::TAN:           return "tan";
+        case TokenType::LOG:           return "log";
+        case TokenType::EXP:           return "exp";
+        case TokenType::NUMBER:        return "number";
+        case TokenType::IDENTIFIER:    return "identifier";
+        case TokenType::END:           return "end";
+        default:                       return "?";
+    }
+}
+
 Lexer::Lexer(const std::string& input) : input(input), position(0), length(input.length()) {
 }
 
@@ -17,36 +89,42 @@ void Lexer::advance() {
 }
 
 void Lexer::skipWhitespace() {
-    while (position < length && std::isspace(currentChar())) {
+    while (position < length && isSpace(currentChar())) {
         advance();
     }
 }
 
 double Lexer::readNumber() {
-    std::string number;
+    size_t begin = position;
     bool hasDot = false;
     
-    while (position < length && (std::isdigit(currentChar()) || currentChar() == '.')) {
+    while (position < length && (isDigit(currentChar()) || currentChar() == '.')) {
         if (currentChar() == '.') {
             if (hasDot) {
                 throw std::runtime_error("无效的数字格式：多个小数点");
             }
             hasDot = true;
         }
-        number += currentChar();
         advance();
     }
     
-    return std::stod(number);
+    return parseLiteral(input.data() + begin, input.data() + position);
 }
 
-std::string Lexer::readIdentifier() {
-    std::string identifier;
-    while (position < length && (std::isalnum(currentChar()) || currentChar() == '_')) {
-        identifier += currentChar();
+std::string_view Lexer::readIdentifier() {
+    size_t begin = position;
+    while (position < length && (isAlnum(currentChar()) || currentChar() == '_')) {
         advance();
     }
-    return identifier;
+    return std::string_view(input).substr(begin, position - begin);
+}
+
+bool Lexer::nextIsLeftParen() const {
+    size_t pos = position;
+    while (pos < length && isSpace(input[pos])) {
+        pos++;
+    }
+    return pos < length && input[pos] == '(';
 }
 
 Token Lexer::getNextToken() {
@@ -59,14 +137,15 @@ Token Lexer::getNextToken() {
     char ch = currentChar();
     
     // 处理数字
-    if (std::isdigit(ch) || ch == '.') {
+    if (isDigit(ch) || ch == '.') {
+        size_t begin = position;
         double value = readNumber();
-        return Token(TokenType::NUMBER, value, std::to_string(value));
+        return Token(TokenType::NUMBER, value, std::string_view(input).substr(begin, position - begin));
     }
     
     // 处理标识符和函数名
-    if (std::isalpha(ch)) {
-        std::string identifier = readIdentifier();
+    if (isAlpha(ch)) {
+        std::string_view identifier = readIdentifier();
         
         if (identifier == "sqrt") return Token(TokenType::SQRT, 0, identifier);
         if (identifier == "sin") return Token(TokenType::SIN, 0, identifier);
@@ -74,8 +153,16 @@ Token Lexer::getNextToken() {
         if (identifier == "tan") return Token(TokenType::TAN, 0, identifier);
         if (identifier == "log") return Token(TokenType::LOG, 0, identifier);
         if (identifier == "exp") return Token(TokenType::EXP, 0, identifier);
+        if (identifier == "if") return Token(TokenType::IF, 0, identifier);
+        // 归约名只在后跟 '(' 时作为关键字，其余情况仍可用作变量名（例如名为 min 的数据列）
+        if (nextIsLeftParen()) {
+            if (identifier == "sum") return Token(TokenType::SUM, 0, identifier);
+            if (identifier == "prod") return Token(TokenType::PROD, 0, identifier);
+            if (identifier == "min") return Token(TokenType::MIN, 0, identifier);
+            if (identifier == "max") return Token(TokenType::MAX, 0, identifier);
+        }
         
-        return Token(TokenType::INVALID, 0, identifier);
+        return Token(TokenType::IDENTIFIER, 0, identifier);
     }
     
     // 处理操作符
@@ -101,9 +188,60 @@ Token Lexer::getNextToken() {
         case ')':
             advance();
             return Token(TokenType::RIGHT_PAREN, 0, ")");
+        case '<':
+            advance();
+            if (currentChar() == '=') {
+                advance();
+                return Token(TokenType::LESS_EQUAL, 0, "<=");
+            }
+            return Token(TokenType::LESS, 0, "<");
+        case '>':
+            advance();
+            if (currentChar() == '=') {
+                advance();
+                return Token(TokenType::GREATER_EQUAL, 0, ">=");
+            }
+            return Token(TokenType::GREATER, 0, ">");
+        case '=':
+            advance();
+            if (currentChar() == '=') {
+                advance();
+                return Token(TokenType::EQUAL, 0, "==");
+            }
+            return Token(TokenType::INVALID, 0, "=");
+        case '!':
+            advance();
+            if (currentChar() == '=') {
+                advance();
+                return Token(TokenType::NOT_EQUAL, 0, "!=");
+            }
+            return Token(TokenType::INVALID, 0, "!");
+        case '&':
+            advance();
+            if (currentChar() == '&') {
+                advance();
+                return Token(TokenType::AND, 0, "&&");
+            }
+            return Token(TokenType::INVALID, 0, "&");
+        case '|':
+            advance();
+            if (currentChar() == '|') {
+                advance();
+                return Token(TokenType::OR, 0, "||");
+            }
+            return Token(TokenType::INVALID, 0, "|");
+        case '?':
+            advance();
+            return Token(TokenType::QUESTION, 0, "?");
+        case ':':
+            advance();
+            return Token(TokenType::COLON, 0, ":");
+        case ',':
+            advance();
+            return Token(TokenType::COMMA, 0, ",");
         default:
             advance();
-            return Token(TokenType::INVALID, 0, std::string(1, ch));
+            return Token(TokenType::INVALID, 0, std::string_view(input).substr(position - 1, 1));
     }
 }
 
@@ -113,12 +251,12 @@ std::vector<Token> Lexer::tokenize() {
     
     while (token.type != TokenType::END) {
         if (token.type == TokenType::INVALID) {
-            throw std::runtime_error("无效字符：" + token.text);
+            throw std::runtime_error("无效字符：" + std::string(token.text));
         }
-        tokens.push_back(token);
+        tokens.push_back(std::move(token));
         token = getNextToken();
     }
     
-    tokens.push_back(token); // 添加END令牌
+    tokens.push_back(std::move(token)); // 添加END令牌
     return tokens;
 }
@@ -1,6 +1,14 @@
 #include "calculator.h"
+#include "column_stream.h"
+#include "compiler.h"
+#include "persistent_cache.h"
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <string>
+#include <vector>
 
 void printUsage(const char* program_name) {
     std::cout << "Usage: " << program_name << " [OPTIONS] [EXPRESSION]\n\n";
@@ -8,9 +16,108 @@ void printUsage(const char* program_name) {
     std::cout << "  -h, --help     Show this help message\n";
     std::cout << "  -v, --version  Show version information\n";
     std::cout << "  -i, --interactive  Start interactive mode (default)\n";
+    std::cout << "  --columns FILE     Evaluate EXPRESSION over every row of a column file\n";
+    std::cout << "                     (CSV with a header row by default)\n";
+    std::cout << "  --binary NAMES     Read FILE as little-endian float64 records with the\n";
+    std::cout << "                     comma-separated column NAMES\n";
+    std::cout << "  --output FORMAT    Column mode result format: text (one value per line,\n";
+    std::cout << "                     default) or binary (little-endian float64)\n";
+    std::cout << "  --chunk-rows N     Rows per streamed chunk in column mode, 1 to "
+              << MAX_COLUMN_CHUNK_ROWS << "\n";
+    std::cout << "                     (default 65536)\n";
+    std::cout << "  --profile          Print per-node call counts and time for EXPRESSION\n";
+    std::cout << "  --profile-json     Same as --profile, as JSON\n";
+    std::cout << "  --cache PATH       Share results and compiled expressions across runs through\n";
+    std::cout << "                     a memory-mapped cache file (default: $CALCULATOR_CACHE)\n";
+    std::cout << "  --cache-size MB    Size cap of a newly created cache file (default 16)\n";
     std::cout << "\nExamples:\n";
     std::cout << "  " << program_name << " \"2 + 3 * 4\"    # Calculate expression directly\n";
     std::cout << "  " << program_name << " -i             # Start interactive mode\n";
+    std::cout << "  " << program_name << " --columns data.csv \"price * qty * (1 - disc)\"\n";
+    std::cout << "  " << program_name << " --columns data.bin --binary a,b --output binary \"b - a^2\"\n";
+    std::cout << "  " << program_name << " --profile \"sin(2)^3 + log(5)\"\n";
+    std::cout << "  " << program_name << " --cache /tmp/calc.cache \"sum(i, 1, 10000000, 1 / i^2)\"\n";
+}
+
+// Parse a decimal count in [1, max]; rejects signs, suffixes and overflow
+bool parseCount(const std::string& text, size_t max, size_t& value) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    try {
+        unsigned long long parsed = std::stoull(text);
+        if (parsed == 0 || parsed > max) {
+            return false;
+        }
+        value = static_cast<size_t>(parsed);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+std::vector<std::string> splitNames(const std::string& text) {
+    std::vector<std::string> names;
+    size_t start = 0;
+    while (true) {
+        size_t comma = text.find(',', start);
+        names.push_back(text.substr(start, comma - start));
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return names;
+}
+
+// The cache is only an accelerator: when it cannot be opened, run without it
+std::unique_ptr<PersistentCache> openCache(const std::string& path, size_t capacity) {
+    if (path.empty()) {
+        return nullptr;
+    }
+    try {
+        return std::make_unique<PersistentCache>(path, capacity);
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: cache disabled: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+int runColumns(const std::string& path, const std::string& expression,
+               const std::vector<std::string>& binary_names, ColumnOutputFormat format,
+               size_t chunk_rows, PersistentCache* cache) {
+    try {
+        // Reuse the compiled program from the cache to skip lexing and parsing
+        std::shared_ptr<const Program> program = cache ? cache->lookupProgram(expression) : nullptr;
+        if (!program) {
+            ProgramBuilder builder;
+            builder.addOutput(compileExpression(builder, expression));
+            program = std::make_shared<const Program>(builder.build());
+            if (cache) {
+                cache->storeProgram(expression, *program);
+            }
+        }
+        
+        bool binary = !binary_names.empty();
+        std::ifstream file(path, binary ? std::ios::in | std::ios::binary : std::ios::in);
+        if (!file) {
+            std::cerr << "Error: cannot open " << path << std::endl;
+            return 1;
+        }
+        
+        std::ios::sync_with_stdio(false);
+        if (binary) {
+            BinaryColumnSource source(file, binary_names);
+            evaluateColumns(*program, source, std::cout, format, chunk_rows);
+        } else {
+            CsvColumnSource source(file);
+            evaluateColumns(*program, source, std::cout, format, chunk_rows);
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
 }
 
 void printVersion() {
@@ -27,11 +134,60 @@ int main(int argc, char* argv[]) {
         return 0;
     }
     
+    std::string columns_file;
+    std::vector<std::string> binary_names;
+    ColumnOutputFormat output_format = ColumnOutputFormat::TEXT;
+    size_t chunk_rows = 65536;
+    std::string profile_format;
+    const char* cache_env = std::getenv("CALCULATOR_CACHE");
+    std::string cache_path = cache_env ? cache_env : "";
+    size_t cache_size = PersistentCache::DEFAULT_CAPACITY;
+    
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
         
-        if (arg == "-h" || arg == "--help") {
+        if ((arg == "--columns" || arg == "--binary" || arg == "--output" || arg == "--chunk-rows" ||
+             arg == "--cache" || arg == "--cache-size") && i + 1 >= argc) {
+            std::cerr << "Error: " << arg << " requires a value" << std::endl;
+            return 1;
+        }
+        
+        if (arg == "--columns") {
+            columns_file = argv[++i];
+        } else if (arg == "--binary") {
+            binary_names = splitNames(argv[++i]);
+        } else if (arg == "--output") {
+            std::string format = argv[++i];
+            if (format == "text") {
+                output_format = ColumnOutputFormat::TEXT;
+            } else if (format == "binary") {
+                output_format = ColumnOutputFormat::BINARY;
+            } else {
+                std::cerr << "Error: --output must be text or binary" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--chunk-rows") {
+            if (!parseCount(argv[++i], MAX_COLUMN_CHUNK_ROWS, chunk_rows)) {
+                std::cerr << "Error: --chunk-rows must be an integer from 1 to "
+                          << MAX_COLUMN_CHUNK_ROWS << std::endl;
+                return 1;
+            }
+        } else if (arg == "--cache") {
+            cache_path = argv[++i];
+        } else if (arg == "--cache-size") {
+            size_t megabytes = 0;
+            if (!parseCount(argv[++i], std::numeric_limits<size_t>::max() >> 20, megabytes)) {
+                std::cerr << "Error: --cache-size must be a positive integer of at most "
+                          << (std::numeric_limits<size_t>::max() >> 20) << " MB" << std::endl;
+                return 1;
+            }
+            cache_size = megabytes << 20;
+        } else if (arg == "--profile") {
+            profile_format = "text";
+        } else if (arg == "--profile-json") {
+            profile_format = "json";
+        } else if (arg == "-h" || arg == "--help") {
             printUsage(argv[0]);
             return 0;
         } else if (arg == "-v" || arg == "--version") {
@@ -40,10 +196,32 @@ int main(int argc, char* argv[]) {
         } else if (arg == "-i" || arg == "--interactive") {
             calculator.run();
             return 0;
+        } else if (!profile_format.empty()) {
+            // Profile the expression per AST node
+            try {
+                ProfileReport report = calculator.profile(arg);
+                std::cout << (profile_format == "json" ? report.toJson() + "\n" : report.toText());
+                return 0;
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return 1;
+            }
+        } else if (!columns_file.empty()) {
+            // Evaluate expression over the column file
+            auto cache = openCache(cache_path, cache_size);
+            return runColumns(columns_file, arg, binary_names, output_format, chunk_rows, cache.get());
         } else {
             // Treat as expression to calculate
             try {
-                double result = calculator.evaluate(arg);
+                // A cache hit skips lexing, parsing and evaluation entirely
+                auto cache = openCache(cache_path, cache_size);
+                double result = 0.0;
+                if (!cache || !cache->lookupResult(arg, result)) {
+                    result = calculator.evaluate(arg);
+                    if (cache) {
+                        cache->storeResult(arg, result);
+                    }
+                }
                 std::cout << "Result: " << result << std::endl;
                 return 0;
             } catch (const std::exception& e) {
@@ -53,5 +231,10 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    if (!columns_file.empty() || !profile_format.empty()) {
+        std::cerr << "Error: missing expression" << std::endl;
+        return 1;
+    }
+    
     return 0;
 }
@@ -0,0 +1,359 @@
+#include "optimizer.h"
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr long long INT_MAX_VALUE = std::numeric_limits<long long>::max();
+constexpr long long INT_MIN_VALUE = std::numeric_limits<long long>::min();
+
+// 带溢出检查的 int64 运算，溢出时返回 false
+bool checkedAdd(long long a, long long b, long long& result) {
+#if defined(__GNUC__) || defined(__clang__)
+    return !__builtin_add_overflow(a, b, &result);
+#else
+    if ((b > 0 && a > INT_MAX_VALUE - b) || (b < 0 && a < INT_MIN_VALUE - b)) {
+        return false;
+    }
+    result = a + b;
+    return true;
+#endif
+}
+
+bool checkedSub(long long a, long long b, long long& result) {
+#if defined(__GNUC__) || defined(__clang__)
+    return !__builtin_sub_overflow(a, b, &result);
+#else
+    if ((b < 0 && a > INT_MAX_VALUE + b) || (b > 0 && a < INT_MIN_VALUE + b)) {
+        return false;
+    }
+    result = a - b;
+    return true;
+#endif
+}
+
+bool checkedMul(long long a, long long b, long long& result) {
+#if defined(__GNUC__) || defined(__clang__)
+    return !__builtin_mul_overflow(a, b, &result);
+#else
+    if (a != 0 && b != 0) {
+        if ((a == -1 && b == INT_MIN_VALUE) || (b == -1 && a == INT_MIN_VALUE)) {
+            return false;
+        }
+        long long product = a * b;
+        if (product / b != a) {
+            return false;
+        }
+    }
+    result = a * b;
+    return true;
+#endif
+}
+
+// 平方求幂（int64，带溢出检查），要求 exponent >= 0
+bool checkedPow(long long base, long long exponent, long long& result) {
+    if (base == 0 || base == 1) {
+        result = exponent == 0 ? 1 : base;
+        return true;
+    }
+    if (base == -1) {
+        result = (exponent % 2 == 0) ? 1 : -1;
+        return true;
+    }
+    
+    long long acc = 1;
+    while (exponent > 0) {
+        if (exponent & 1) {
+            if (!checkedMul(acc, base, acc)) {
+                return false;
+            }
+        }
+        exponent >>= 1;
+        if (exponent > 0 && !checkedMul(base, base, base)) {
+            return false;
+        }
+    }
+    result = acc;
+    return true;
+}
+
+// double 是否为可精确转换为 int64 的整数
+bool toInteger(double value, long long& result) {
+    // [-2^63, 2^63) 范围内的整数值才能无损转换
+    if (!(value >= -9223372036854775808.0 && value < 9223372036854775808.0)) {
+        return false;
+    }
+    if (value != std::trunc(value)) {
+        return false;
+    }
+    result = static_cast<long long>(value);
+    return true;
+}
+
+// c 的倒数是否可精确表示（c 为 2 的整数次幂且倒数为规格化数）
+bool hasExactReciprocal(double c, double& reciprocal) {
+    if (c == 0.0 || !std::isfinite(c)) {
+        return false;
+    }
+    int exp = 0;
+    double mantissa = std::frexp(c, &exp);
+    if (std::fabs(mantissa) != 0.5) {
+        return false;
+    }
+    reciprocal = 1.0 / c;
+    return std::isnormal(reciprocal);
+}
+
+const NumberNode* asNumber(const std::unique_ptr<ASTNode>& node) {
+    return dynamic_cast<const NumberNode*>(node.get());
+}
+
+} // namespace
+
+std::unique_ptr<ASTNode> optimizeAST(std::unique_ptr<ASTNode> root) {
+    auto replacement = root->optimize();
+    return replacement ? std::move(replacement) : std::move(root);
+}
+
+double evaluateWithFastPath(ASTNode& root, bool integer_only) {
+    long long integer_result = 0;
+    if (integer_only && root.evaluateInteger(integer_result)) {
+        return static_cast<double>(integer_result);
+    }
+    return root.evaluate();
+}
+
+bool NumberNode::evaluateInteger(long long& result) const {
+    return toInteger(value, result);
+}
+
+bool NumberNode::isIntegerOnly() const {
+    long long integer = 0;
+    return toInteger(value, integer);
+}
+
+std::unique_ptr<ASTNode> BinaryOpNode::optimize() {
+    left = optimizeAST(std::move(left));
+    right = optimizeAST(std::move(right));
+    
+    const NumberNode* constant = asNumber(right);
+    if (!constant) {
+        return nullptr;
+    }
+    double c = constant->getValue();
+    
+    if (operator_type == TokenType::POWER) {
+        if (c == 0.5) {
+            return std::make_unique<SqrtPowerNode>(std::move(left));
+        }
+        long long n = 0;
+        if (toInteger(c, n) && n >= 0 && n <= MAX_INT_POWER_EXPONENT) {
+            return std::make_unique<IntPowerNode>(std::move(left), static_cast<int>(n));
+        }
+    }
+    
+    if (operator_type == TokenType::DIVIDE) {
+        // 仅当倒数精确时改写，保证 x * (1/c) 与 x / c 逐位相同
+        double reciprocal = 0.0;
+        if (hasExactReciprocal(c, reciprocal)) {
+            return std::make_unique<BinaryOpNode>(std::move(left), TokenType::MULTIPLY,
+                                                  std::make_unique<NumberNode>(reciprocal));
+        }
+    }
+    
+    return nullptr;
+}
+
+bool BinaryOpNode::evaluateInteger(long long& result) const {
+    long long left_val = 0;
+    long long right_val = 0;
+    if (!left->evaluateInteger(left_val) || !right->evaluateInteger(right_val)) {
+        return false;
+    }
+    
+    switch (operator_type) {
+        case TokenType::PLUS:
+            return checkedAdd(left_val, right_val, result);
+        case TokenType::MINUS:
+            return checkedSub(left_val, right_val, result);
+        case TokenType::MULTIPLY:
+            return checkedMul(left_val, right_val, result);
+        case TokenType::POWER:
+            // 负指数的结果不是整数，交给 double 路径
+            return right_val >= 0 && checkedPow(left_val, right_val, result);
+        case TokenType::LESS:
+            result = left_val < right_val;
+            return true;
+        case TokenType::LESS_EQUAL:
+            result = left_val <= right_val;
+            return true;
+        case TokenType::GREATER:
+            result = left_val > right_val;
+            return true;
+        case TokenType::GREATER_EQUAL:
+            result = left_val >= right_val;
+            return true;
+        case TokenType::EQUAL:
+            result = left_val == right_val;
+            return true;
+        case TokenType::NOT_EQUAL:
+            result = left_val != right_val;
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool BinaryOpNode::isIntegerOnly() const {
+    switch (operator_type) {
+        case TokenType::PLUS:
+        case TokenType::MINUS:
+        case TokenType::MULTIPLY:
+        case TokenType::POWER:
+        case TokenType::LESS:
+        case TokenType::LESS_EQUAL:
+        case TokenType::GREATER:
+        case TokenType::GREATER_EQUAL:
+        case TokenType::EQUAL:
+        case TokenType::NOT_EQUAL:
+            return left->isIntegerOnly() && right->isIntegerOnly();
+        default:
+            return false;
+    }
+}
+
+std::unique_ptr<ASTNode> LogicalNode::optimize() {
+    left = optimizeAST(std::move(left));
+    right = optimizeAST(std::move(right));
+    return nullptr;
+}
+
+bool LogicalNode::evaluateInteger(long long& result) const {
+    long long left_val = 0;
+    if (!left->evaluateInteger(left_val)) {
+        return false;
+    }
+    
+    // 与 double 路径一致的短路求值
+    bool short_circuit = operator_type == TokenType::AND ? left_val == 0 : left_val != 0;
+    if (short_circuit) {
+        result = left_val != 0;
+        return true;
+    }
+    long long right_val = 0;
+    if (!right->evaluateInteger(right_val)) {
+        return false;
+    }
+    result = right_val != 0;
+    return true;
+}
+
+bool LogicalNode::isIntegerOnly() const {
+    return left->isIntegerOnly() && right->isIntegerOnly();
+}
+
+std::unique_ptr<ASTNode> ConditionalNode::optimize() {
+    condition = optimizeAST(std::move(condition));
+    when_true = optimizeAST(std::move(when_true));
+    when_false = optimizeAST(std::move(when_false));
+    return nullptr;
+}
+
+bool ConditionalNode::evaluateInteger(long long& result) const {
+    long long condition_val = 0;
+    if (!condition->evaluateInteger(condition_val)) {
+        return false;
+    }
+    return condition_val != 0 ? when_true->evaluateInteger(result) : when_false->evaluateInteger(result);
+}
+
+bool ConditionalNode::isIntegerOnly() const {
+    return condition->isIntegerOnly() && when_true->isIntegerOnly() && when_false->isIntegerOnly();
+}
+
+std::unique_ptr<ASTNode> UnaryOpNode::optimize() {
+    operand = optimizeAST(std::move(operand));
+    
+    // 常量的正负号直接折叠，使 x^-2、x / -4 的右侧成为常量，可以继续改写
+    const NumberNode* constant = asNumber(operand);
+    if (!constant) {
+        return nullptr;
+    }
+    switch (operator_type) {
+        case TokenType::PLUS:  return std::make_unique<NumberNode>(constant->getValue());
+        case TokenType::MINUS: return std::make_unique<NumberNode>(-constant->getValue());
+        default:               return nullptr;
+    }
+}
+
+bool UnaryOpNode::evaluateInteger(long long& result) const {
+    long long operand_val = 0;
+    if (!operand->evaluateInteger(operand_val)) {
+        return false;
+    }
+    
+    switch (operator_type) {
+        case TokenType::PLUS:
+            result = operand_val;
+            return true;
+        case TokenType::MINUS:
+            return checkedSub(0, operand_val, result);
+        default:
+            return false;
+    }
+}
+
+bool UnaryOpNode::isIntegerOnly() const {
+    return (operator_type == TokenType::PLUS || operator_type == TokenType::MINUS) && operand->isIntegerOnly();
+}
+
+std::unique_ptr<ASTNode> FunctionNode::optimize() {
+    argument = optimizeAST(std::move(argument));
+    return nullptr;
+}
+
+std::unique_ptr<ASTNode> ReductionNode::optimize() {
+    lower = optimizeAST(std::move(lower));
+    upper = optimizeAST(std::move(upper));
+    body = optimizeAST(std::move(body));
+    return nullptr;
+}
+
+double IntPowerNode::evaluate() {
+    double x = base->evaluate();
+    
+    // 平方求幂：n 次乘方只需 O(log n) 次乘法
+    unsigned int n = static_cast<unsigned int>(exponent);
+    double result = 1.0;
+    while (n > 0) {
+        if (n & 1u) {
+            result *= x;
+        }
+        n >>= 1;
+        if (n > 0) {
+            x *= x;
+        }
+    }
+    return result;
+}
+
+bool IntPowerNode::evaluateInteger(long long& result) const {
+    long long base_val = 0;
+    if (!base->evaluateInteger(base_val)) {
+        return false;
+    }
+    return checkedPow(base_val, exponent, result);
+}
+
+bool IntPowerNode::isIntegerOnly() const {
+    return base->isIntegerOnly();
+}
+
+double SqrtPowerNode::evaluate() {
+    double x = base->evaluate();
+    // 与 std::pow(x, 0.5) 保持一致：pow(-0, 0.5) = +0，pow(-inf, 0.5) = +inf
+    if (x == 0.0 || std::isinf(x)) {
+        return std::fabs(x);
+    }
+    return std::sqrt(x);
+}
@@ -1,6 +1,11 @@
 #include "parser.h"
 #include <stdexcept>
 #include <cmath>
+#include <sstream>
+
+double VariableNode::evaluate() {
+    throw std::runtime_error("未定义的变量：" + name);
+}
 
 double BinaryOpNode::evaluate() {
     double left_val = left->evaluate();
@@ -20,11 +25,39 @@ double BinaryOpNode::evaluate() {
             return left_val / right_val;
         case TokenType::POWER:
             return std::pow(left_val, right_val);
+        case TokenType::LESS:
+            return left_val < right_val ? 1.0 : 0.0;
+        case TokenType::LESS_EQUAL:
+            return left_val <= right_val ? 1.0 : 0.0;
+        case TokenType::GREATER:
+            return left_val > right_val ? 1.0 : 0.0;
+        case TokenType::GREATER_EQUAL:
+            return left_val >= right_val ? 1.0 : 0.0;
+        case TokenType::EQUAL:
+            return left_val == right_val ? 1.0 : 0.0;
+        case TokenType::NOT_EQUAL:
+            return left_val != right_val ? 1.0 : 0.0;
         default:
             throw std::runtime_error("未知的二元操作符");
     }
 }
 
+double LogicalNode::evaluate() {
+    // 短路求值：左侧已能确定结果时不计算右侧
+    bool left_true = left->evaluate() != 0.0;
+    if (operator_type == TokenType::AND) {
+        return (left_true && right->evaluate() != 0.0) ? 1.0 : 0.0;
+    }
+    if (operator_type == TokenType::OR) {
+        return (left_true || right->evaluate() != 0.0) ? 1.0 : 0.0;
+    }
+    throw std::runtime_error("未知的逻辑操作符");
+}
+
+double ConditionalNode::evaluate() {
+    return condition->evaluate() != 0.0 ? when_true->evaluate() : when_false->evaluate();
+}
+
 double UnaryOpNode::evaluate() {
     double operand_val = operand->evaluate();
     
@@ -65,6 +98,100 @@ double FunctionNode::evaluate() {
     }
 }
 
+std::unique_ptr<ASTNode>& ASTNode::child(size_t) {
+    throw std::out_of_range("子节点索引越界");
+}
+
+std::string NumberNode::describe() const {
+    std::ostringstream text;
+    text << "NumberNode(" << value << ")";
+    return text.str();
+}
+
+std::string VariableNode::describe() const {
+    return "VariableNode(" + name + ")";
+}
+
+std::string BinaryOpNode::describe() const {
+    return std::string("BinaryOpNode(") + tokenSymbol(operator_type) + ")";
+}
+
+std::unique_ptr<ASTNode>& BinaryOpNode::child(size_t index) {
+    if (index > 1) {
+        return ASTNode::child(index);
+    }
+    return index == 0 ? left : right;
+}
+
+std::string UnaryOpNode::describe() const {
+    return std::string("UnaryOpNode(") + tokenSymbol(operator_type) + ")";
+}
+
+std::unique_ptr<ASTNode>& UnaryOpNode::child(size_t index) {
+    return index == 0 ? operand : ASTNode::child(index);
+}
+
+std::string FunctionNode::describe() const {
+    return std::string("FunctionNode(") + tokenSymbol(function_type) + ")";
+}
+
+std::unique_ptr<ASTNode>& FunctionNode::child(size_t index) {
+    return index == 0 ? argument : ASTNode::child(index);
+}
+
+std::string LogicalNode::describe() const {
+    return std::string("LogicalNode(") + tokenSymbol(operator_type) + ")";
+}
+
+std::unique_ptr<ASTNode>& LogicalNode::child(size_t index) {
+    if (index > 1) {
+        return ASTNode::child(index);
+    }
+    return index == 0 ? left : right;
+}
+
+std::string ConditionalNode::describe() const {
+    return "ConditionalNode(?:)";
+}
+
+std::unique_ptr<ASTNode>& ConditionalNode::child(size_t index) {
+    switch (index) {
+        case 0: return condition;
+        case 1: return when_true;
+        case 2: return when_false;
+        default: return ASTNode::child(index);
+    }
+}
+
+std::string ReductionNode::describe() const {
+    return std::string("ReductionNode(") + tokenSymbol(reduction_type) + " " + variable + ")";
+}
+
+std::unique_ptr<ASTNode>& ReductionNode::child(size_t index) {
+    switch (index) {
+        case 0: return lower;
+        case 1: return upper;
+        case 2: return body;
+        default: return ASTNode::child(index);
+    }
+}
+
+std::string IntPowerNode::describe() const {
+    return "IntPowerNode(^" + std::to_string(exponent) + ")";
+}
+
+std::unique_ptr<ASTNode>& IntPowerNode::child(size_t index) {
+    return index == 0 ? base : ASTNode::child(index);
+}
+
+std::string SqrtPowerNode::describe() const {
+    return "SqrtPowerNode(^0.5)";
+}
+
+std::unique_ptr<ASTNode>& SqrtPowerNode::child(size_t index) {
+    return index == 0 ? base : ASTNode::child(index);
+}
+
 Parser::Parser(const std::vector<Token>& tokens) : tokens(tokens), current_token_index(0), current_token(TokenType::END) {
     if (!tokens.empty()) {
         current_token = tokens[0];
@@ -87,6 +214,76 @@ void Parser::eat(TokenType expected_type) {
 }
 
 std::unique_ptr<ASTNode> Parser::expression() {
+    return conditional();
+}
+
+std::unique_ptr<ASTNode> Parser::conditional() {
+    auto node = logicalOr();
+    
+    // 条件运算符是右结合的：a ? b : c ? d : e 等价于 a ? b : (c ? d : e)
+    if (current_token.type == TokenType::QUESTION) {
+        eat(TokenType::QUESTION);
+        auto when_true = conditional();
+        eat(TokenType::COLON);
+        auto when_false = conditional();
+        node = std::make_unique<ConditionalNode>(std::move(node), std::move(when_true), std::move(when_false));
+    }
+    
+    return node;
+}
+
+std::unique_ptr<ASTNode> Parser::logicalOr() {
+    auto node = logicalAnd();
+    
+    while (current_token.type == TokenType::OR) {
+        eat(TokenType::OR);
+        auto right = logicalAnd();
+        node = std::make_unique<LogicalNode>(std::move(node), TokenType::OR, std::move(right));
+    }
+    
+    return node;
+}
+
+std::unique_ptr<ASTNode> Parser::logicalAnd() {
+    auto node = equality();
+    
+    while (current_token.type == TokenType::AND) {
+        eat(TokenType::AND);
+        auto right = equality();
+        node = std::make_unique<LogicalNode>(std::move(node), TokenType::AND, std::move(right));
+    }
+    
+    return node;
+}
+
+std::unique_ptr<ASTNode> Parser::equality() {
+    auto node = comparison();
+    
+    while (current_token.type == TokenType::EQUAL || current_token.type == TokenType::NOT_EQUAL) {
+        TokenType op = current_token.type;
+        eat(op);
+        auto right = comparison();
+        node = std::make_unique<BinaryOpNode>(std::move(node), op, std::move(right));
+    }
+    
+    return node;
+}
+
+std::unique_ptr<ASTNode> Parser::comparison() {
+    auto node = additive();
+    
+    while (current_token.type == TokenType::LESS || current_token.type == TokenType::LESS_EQUAL ||
+           current_token.type == TokenType::GREATER || current_token.type == TokenType::GREATER_EQUAL) {
+        TokenType op = current_token.type;
+        eat(op);
+        auto right = additive();
+        node = std::make_unique<BinaryOpNode>(std::move(node), op, std::move(right));
+    }
+    
+    return node;
+}
+
+std::unique_ptr<ASTNode> Parser::additive() {
     auto node = term();
     
     while (current_token.type == TokenType::PLUS || current_token.type == TokenType::MINUS) {
@@ -146,6 +343,11 @@ std::unique_ptr<ASTNode> Parser::factor() {
         return std::make_unique<NumberNode>(token.value);
     }
     
+    if (token.type == TokenType::IDENTIFIER) {
+        eat(TokenType::IDENTIFIER);
+        return std::make_unique<VariableNode>(std::string(token.text));
+    }
+    
     if (token.type == TokenType::LEFT_PAREN) {
         eat(TokenType::LEFT_PAREN);
         auto node = expression();
@@ -153,6 +355,38 @@ std::unique_ptr<ASTNode> Parser::factor() {
         return node;
     }
     
+    // 处理条件函数 if(cond, a, b)
+    if (token.type == TokenType::IF) {
+        eat(TokenType::IF);
+        eat(TokenType::LEFT_PAREN);
+        auto condition = expression();
+        eat(TokenType::COMMA);
+        auto when_true = expression();
+        eat(TokenType::COMMA);
+        auto when_false = expression();
+        eat(TokenType::RIGHT_PAREN);
+        return std::make_unique<ConditionalNode>(std::move(condition), std::move(when_true), std::move(when_false));
+    }
+    
+    // 处理区间归约 sum/prod/min/max(i, lo, hi, body)
+    if (token.type == TokenType::SUM || token.type == TokenType::PROD ||
+        token.type == TokenType::MIN || token.type == TokenType::MAX) {
+        TokenType reduction_type = token.type;
+        eat(reduction_type);
+        eat(TokenType::LEFT_PAREN);
+        std::string variable(current_token.text);
+        eat(TokenType::IDENTIFIER);
+        eat(TokenType::COMMA);
+        auto lower = expression();
+        eat(TokenType::COMMA);
+        auto upper = expression();
+        eat(TokenType::COMMA);
+        auto body = expression();
+        eat(TokenType::RIGHT_PAREN);
+        return std::make_unique<ReductionNode>(reduction_type, variable, std::move(lower),
+                                               std::move(upper), std::move(body));
+    }
+    
     // 处理数学函数
     if (token.type == TokenType::SQRT || token.type == TokenType::SIN || 
         token.type == TokenType::COS || token.type == TokenType::TAN ||
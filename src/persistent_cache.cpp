@@ -0,0 +1,280 @@
+#include "persistent_cache.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 文件头：magic 同时标识格式版本；head 为已预留的记录区字数（逻辑位置，单调递增）
+struct PersistentCache::Header {
+    std::atomic<std::uint64_t> magic;
+    std::atomic<std::uint64_t> head;
+    std::uint64_t reserved[6];
+};
+
+// 槽：key 为表达式哈希，position 为记录的逻辑位置 + 1（0 表示空）
+struct PersistentCache::Slot {
+    std::atomic<std::uint64_t> key;
+    std::atomic<std::uint64_t> position;
+};
+
+namespace {
+
+constexpr std::uint64_t CACHE_MAGIC = 0x3143414352505845ull;  // "EXPRCAC1"
+
+// 查找与插入时最多探测的槽数
+constexpr size_t MAX_PROBE = 8;
+
+// 记录头：key、长度字、校验和
+constexpr size_t RECORD_HEADER_WORDS = 3;
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "持久缓存要求 64 位原子操作无锁（跨进程共享）");
+
+std::uint64_t hashKey(std::uint8_t kind, const std::string& text) {
+    std::uint64_t hash = 0xcbf29ce484222325ull ^ kind;
+    for (unsigned char ch : text) {
+        hash = (hash ^ ch) * 0x100000001b3ull;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+std::uint64_t mixChecksum(std::uint64_t hash, std::uint64_t word) {
+    hash = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+    return hash ^ (hash >> 29);
+}
+
+size_t payloadWords(size_t bytes) {
+    return (bytes + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+}
+
+} // namespace
+
+#ifdef _WIN32
+
+PersistentCache::PersistentCache(const std::string&, size_t) {
+    throw std::runtime_error("当前平台不支持持久缓存");
+}
+
+PersistentCache::~PersistentCache() = default;
+
+bool PersistentCache::lookup(EntryKind, const std::string&, std::string&) const {
+    return false;
+}
+
+void PersistentCache::store(EntryKind, const std::string&, const std::string&) {
+}
+
+#else
+
+PersistentCache::PersistentCache(const std::string& path, size_t requested_capacity) {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("无法打开缓存文件：" + path);
+    }
+    
+    // 只在创建和校验文件时加锁，之后的读写都是无锁的
+    ::flock(fd, LOCK_EX);
+    struct stat info;
+    bool created = false;
+    size_t size = 0;
+    if (::fstat(fd, &info) == 0) {
+        size = static_cast<size_t>(info.st_size);
+        if (size == 0) {
+            size = (std::max(requested_capacity, MIN_CAPACITY) + 4095) & ~static_cast<size_t>(4095);
+            created = ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+            if (!created) {
+                size = 0;
+            }
+        }
+    }
+    if (size >= MIN_CAPACITY) {
+        mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            mapping = nullptr;
+        }
+    }
+    
+    if (mapping) {
+        mapped_size = size;
+        header = static_cast<Header*>(mapping);
+        if (created) {
+            header->magic.store(CACHE_MAGIC);
+        }
+    }
+    ::flock(fd, LOCK_UN);
+    
+    if (!mapping || header->magic.load() != CACHE_MAGIC) {
+        if (mapping) {
+            ::munmap(mapping, mapped_size);
+        }
+        ::close(fd);
+        throw std::runtime_error("不是有效的缓存文件：" + path);
+    }
+    
+    // 布局完全由文件大小决定：槽表约占 1/16，其余为记录区
+    size_t slot_count = 1;
+    while (slot_count * 2 * sizeof(Slot) * 16 <= mapped_size) {
+        slot_count *= 2;
+    }
+    slots = reinterpret_cast<Slot*>(static_cast<char*>(mapping) + sizeof(Header));
+    slot_mask = slot_count - 1;
+    data = reinterpret_cast<std::atomic<std::uint64_t>*>(slots + slot_count);
+    data_words = (mapped_size - sizeof(Header) - slot_count * sizeof(Slot)) / sizeof(std::uint64_t);
+}
+
+PersistentCache::~PersistentCache() {
+    ::munmap(mapping, mapped_size);
+    ::close(fd);
+}
+
+bool PersistentCache::lookup(EntryKind kind, const std::string& text, std::string& value) const {
+    const std::uint64_t key = hashKey(static_cast<std::uint8_t>(kind), text);
+    std::vector<std::uint64_t> words;
+    
+    for (size_t probe = 0; probe < MAX_PROBE; probe++) {
+        const Slot& slot = slots[(key + probe) & slot_mask];
+        if (slot.key.load(std::memory_order_acquire) != key) {
+            continue;
+        }
+        std::uint64_t position = slot.position.load(std::memory_order_acquire);
+        if (position == 0) {
+            continue;
+        }
+        const std::uint64_t start = position - 1;
+        if (header->head.load(std::memory_order_acquire) > start + data_words) {
+            continue;  // 已被覆盖
+        }
+        
+        // 记录从不跨越记录区末尾
+        const size_t base = start % data_words;
+        if (data[base].load(std::memory_order_relaxed) != key) {
+            continue;
+        }
+        const std::uint64_t lengths = data[base + 1].load(std::memory_order_relaxed);
+        const size_t text_bytes = static_cast<size_t>(lengths & 0xffffffffu);
+        const size_t value_bytes = static_cast<size_t>(lengths >> 32);
+        const size_t body = payloadWords(text_bytes + value_bytes);
+        if (text_bytes != text.size() || RECORD_HEADER_WORDS + body > data_words - base) {
+            continue;
+        }
+        const std::uint64_t checksum = data[base + 2].load(std::memory_order_relaxed);
+        words.resize(body);
+        for (size_t k = 0; k < body; k++) {
+            words[k] = data[base + RECORD_HEADER_WORDS + k].load(std::memory_order_relaxed);
+        }
+        
+        // 读取完成后再次检查：期间没有写入者预留到这段记录，数据才是完整的
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header->head.load(std::memory_order_relaxed) > start + data_words) {
+            continue;
+        }
+        std::uint64_t hash = mixChecksum(mixChecksum(0, key), lengths);
+        for (std::uint64_t word : words) {
+            hash = mixChecksum(hash, word);
+        }
+        if (hash != checksum) {
+            continue;  // 未写完或被并发覆盖
+        }
+        
+        const char* bytes = reinterpret_cast<const char*>(words.data());
+        if (std::memcmp(bytes, text.data(), text_bytes) != 0) {
+            continue;  // 哈希冲突
+        }
+        value.assign(bytes + text_bytes, value_bytes);
+        return true;
+    }
+    return false;
+}
+
+void PersistentCache::store(EntryKind kind, const std::string& text, const std::string& value) {
+    const std::uint64_t key = hashKey(static_cast<std::uint8_t>(kind), text);
+    const size_t body = payloadWords(text.size() + value.size());
+    const size_t record = RECORD_HEADER_WORDS + body;
+    if (text.size() > 0xffffffffu || value.size() > 0xffffffffu || record > data_words / 4) {
+        return;  // 过大的记录不缓存
+    }
+    
+    std::vector<std::uint64_t> words(record, 0);
+    words[0] = key;
+    words[1] = static_cast<std::uint64_t>(text.size()) | (static_cast<std::uint64_t>(value.size()) << 32);
+    char* payload = reinterpret_cast<char*>(words.data() + RECORD_HEADER_WORDS);
+    std::memcpy(payload, text.data(), text.size());
+    std::memcpy(payload + text.size(), value.data(), value.size());
+    std::uint64_t hash = mixChecksum(mixChecksum(0, key), words[1]);
+    for (size_t k = RECORD_HEADER_WORDS; k < record; k++) {
+        hash = mixChecksum(hash, words[k]);
+    }
+    words[2] = hash;
+    
+    // 预留记录区：放不下时跳过末尾剩余部分，从头开始
+    std::uint64_t current = header->head.load();
+    std::uint64_t start;
+    do {
+        const size_t offset = current % data_words;
+        start = offset + record > data_words ? current + (data_words - offset) : current;
+    } while (!header->head.compare_exchange_weak(current, start + record, std::memory_order_acq_rel));
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    const size_t base = start % data_words;
+    for (size_t k = 0; k < record; k++) {
+        data[base + k].store(words[k], std::memory_order_relaxed);
+    }
+    
+    // 插入槽表：复用相同 key 或空槽，否则淘汰探测范围内最旧的记录
+    Slot* victim = nullptr;
+    for (size_t probe = 0; probe < MAX_PROBE; probe++) {
+        Slot& slot = slots[(key + probe) & slot_mask];
+        std::uint64_t existing = slot.key.load(std::memory_order_acquire);
+        if (existing == 0 && slot.key.compare_exchange_strong(existing, key)) {
+            existing = key;
+        }
+        if (existing == key) {
+            slot.position.store(start + 1, std::memory_order_release);
+            return;
+        }
+        if (!victim || slot.position.load() < victim->position.load()) {
+            victim = &slot;
+        }
+    }
+    victim->key.store(key, std::memory_order_release);
+    victim->position.store(start + 1, std::memory_order_release);
+}
+
+#endif
+
+bool PersistentCache::lookupResult(const std::string& expression, double& value) const {
+    std::string bytes;
+    if (!lookup(EntryKind::RESULT, expression, bytes) || bytes.size() != sizeof(value)) {
+        return false;
+    }
+    std::memcpy(&value, bytes.data(), sizeof(value));
+    return true;
+}
+
+void PersistentCache::storeResult(const std::string& expression, double value) {
+    store(EntryKind::RESULT, expression, std::string(reinterpret_cast<const char*>(&value), sizeof(value)));
+}
+
+std::shared_ptr<const Program> PersistentCache::lookupProgram(const std::string& expression) const {
+    std::string bytes;
+    if (!lookup(EntryKind::PROGRAM, expression, bytes)) {
+        return nullptr;
+    }
+    try {
+        return std::make_shared<const Program>(Program::deserialize(bytes));
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+void PersistentCache::storeProgram(const std::string& expression, const Program& program) {
+    store(EntryKind::PROGRAM, expression, program.serialize());
+}
@@ -0,0 +1,221 @@
+#include "profiler.h"
+#include "calculator.h"
+#include "optimizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CALC_HAS_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CALC_HAS_RDTSC 1
+#endif
+
+namespace {
+
+inline std::uint64_t readCycleCounter() {
+#ifdef CALC_HAS_RDTSC
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+const char* cycleUnit() {
+#ifdef CALC_HAS_RDTSC
+    return "cycles";
+#else
+    return "ns";
+#endif
+}
+
+// 估算一次计时本身的开销，用于从父节点的自身耗时中扣除
+std::uint64_t timerOverhead() {
+    std::uint64_t best = ~static_cast<std::uint64_t>(0);
+    for (int i = 0; i < 1000; i++) {
+        std::uint64_t start = readCycleCounter();
+        std::uint64_t end = readCycleCounter();
+        best = std::min(best, end - start);
+    }
+    return best;
+}
+
+ProfileEntry collect(ASTNode& node, std::uint64_t overhead) {
+    ProfileEntry entry;
+    entry.node = node.describe();
+    auto* profiled = dynamic_cast<ProfiledNode*>(&node);
+    entry.measured = profiled != nullptr;
+    if (profiled) {
+        entry.calls = profiled->callCount();
+        entry.cycles = profiled->cycleCount();
+    }
+    
+    std::uint64_t children_cost = 0;
+    for (size_t i = 0; i < node.childCount(); i++) {
+        entry.children.push_back(collect(*node.child(i), overhead));
+        const ProfileEntry& child = entry.children.back();
+        children_cost += child.cycles + child.calls * overhead;
+    }
+    entry.self_cycles = entry.cycles > children_cost ? entry.cycles - children_cost : 0;
+    return entry;
+}
+
+double share(std::uint64_t part, std::uint64_t total) {
+    return total == 0 ? 0.0 : 100.0 * static_cast<double>(part) / static_cast<double>(total);
+}
+
+void appendText(std::string& out, const ProfileEntry& entry, std::uint64_t total, int depth) {
+    char line[128];
+    if (entry.measured) {
+        std::snprintf(line, sizeof(line), "%6.1f%% %6.1f%% %10llu %14llu  ",
+                      share(entry.cycles, total), share(entry.self_cycles, total),
+                      static_cast<unsigned long long>(entry.calls),
+                      static_cast<unsigned long long>(entry.cycles));
+    } else {
+        std::snprintf(line, sizeof(line), "%7s %7s %10s %14s  ", "-", "-", "-", "-");
+    }
+    out += line;
+    out.append(static_cast<size_t>(depth) * 2, ' ');
+    out += entry.node;
+    if (!entry.measured) {
+        out += "  (compiled reduction body, not measured)";
+    }
+    out += '\n';
+    for (const auto& child : entry.children) {
+        appendText(out, child, total, depth + 1);
+    }
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char ch : text) {
+        if (ch == '"' || ch == '\\') {
+            escaped += '\\';
+        }
+        escaped += ch;
+    }
+    return escaped;
+}
+
+// JSON 没有 inf/NaN，非有限值输出为 null
+std::string jsonNumber(double value) {
+    if (!std::isfinite(value)) {
+        return "null";
+    }
+    std::ostringstream out;
+    out << value;
+    return out.str();
+}
+
+void appendJson(std::ostringstream& out, const ProfileEntry& entry, std::uint64_t total) {
+    out << "{\"node\":\"" << jsonEscape(entry.node) << "\""
+        << ",\"measured\":" << (entry.measured ? "true" : "false")
+        << ",\"calls\":" << entry.calls
+        << ",\"cycles\":" << entry.cycles
+        << ",\"self_cycles\":" << entry.self_cycles
+        << ",\"share\":" << jsonNumber(share(entry.cycles, total))
+        << ",\"self_share\":" << jsonNumber(share(entry.self_cycles, total))
+        << ",\"children\":[";
+    for (size_t i = 0; i < entry.children.size(); i++) {
+        if (i > 0) {
+            out << ",";
+        }
+        appendJson(out, entry.children[i], total);
+    }
+    out << "]}";
+}
+
+} // namespace
+
+double ProfiledNode::evaluate() {
+    std::uint64_t start = readCycleCounter();
+    double value = inner->evaluate();
+    cycles += readCycleCounter() - start;
+    calls++;
+    return value;
+}
+
+bool ProfiledNode::evaluateInteger(long long& result) const {
+    std::uint64_t start = readCycleCounter();
+    bool exact = inner->evaluateInteger(result);
+    cycles += readCycleCounter() - start;
+    calls++;
+    return exact;
+}
+
+std::unique_ptr<ASTNode> instrumentAST(std::unique_ptr<ASTNode> root) {
+    // 归约体（第 2 个子节点）由编译后的程序求值，包裹后也不会被调用
+    size_t children = dynamic_cast<ReductionNode*>(root.get()) ? 2 : root->childCount();
+    for (size_t i = 0; i < children; i++) {
+        root->child(i) = instrumentAST(std::move(root->child(i)));
+    }
+    return std::make_unique<ProfiledNode>(std::move(root));
+}
+
+ProfileEntry collectProfile(ASTNode& root) {
+    return collect(root, timerOverhead());
+}
+
+std::string ProfileReport::toText() const {
+    std::ostringstream header;
+    header << "Profile: " << iterations << " evaluations, result = " << result
+           << ", path = " << path << ", total = " << root.cycles << " " << unit << "\n";
+    std::string out = header.str();
+    out += " total%   self%      calls         " + unit + "  node\n";
+    appendText(out, root, root.cycles, 0);
+    return out;
+}
+
+std::string ProfileReport::toJson() const {
+    std::ostringstream out;
+    out << "{\"iterations\":" << iterations
+        << ",\"result\":" << jsonNumber(result)
+        << ",\"path\":\"" << path << "\""
+        << ",\"unit\":\"" << unit << "\""
+        << ",\"total_cycles\":" << root.cycles
+        << ",\"tree\":";
+    appendJson(out, root, root.cycles);
+    out << "}";
+    return out.str();
+}
+
+ProfileReport Calculator::profile(const std::string& expression, size_t iterations) {
+    if (iterations == 0) {
+        throw CalculatorException("Calculation Error: 剖析次数必须为正数");
+    }
+    
+    try {
+        Lexer lexer(expression);
+        Parser parser(lexer.tokenize());
+        auto ast = optimizeAST(parser.parse());
+        
+        // 与 evaluateWithFastPath 相同的路径：整数表达式先走 int64，溢出时回退到 double。
+        // 表达式不含变量，路径在插桩前试算一次即可确定，计时只覆盖实际使用的路径
+        long long integer_result = 0;
+        const bool use_int64 = ast->isIntegerOnly() && ast->evaluateInteger(integer_result);
+        ast = instrumentAST(std::move(ast));
+        
+        ProfileReport report;
+        report.path = use_int64 ? "int64" : "double";
+        for (size_t i = 0; i < iterations; i++) {
+            if (use_int64) {
+                ast->evaluateInteger(integer_result);
+                report.result = static_cast<double>(integer_result);
+            } else {
+                report.result = ast->evaluate();
+            }
+        }
+        report.iterations = iterations;
+        report.unit = cycleUnit();
+        report.root = collectProfile(*ast);
+        return report;
+    } catch (const std::exception& e) {
+        throw CalculatorException("Calculation Error: " + std::string(e.what()));
+    }
+}
@@ -0,0 +1,680 @@
+#include "program.h"
+#include "reduction.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+double powHalf(double x) {
+    // 与 std::pow(x, 0.5) 保持一致：pow(-0, 0.5) = +0，pow(-inf, 0.5) = +inf
+    if (x == 0.0 || std::isinf(x)) {
+        return std::fabs(x);
+    }
+    return std::sqrt(x);
+}
+
+bool isCommutative(OpCode op) {
+    switch (op) {
+        case OpCode::ADD:
+        case OpCode::MUL:
+        case OpCode::EQ:
+        case OpCode::NE:
+        case OpCode::AND:
+        case OpCode::OR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// 按位选择：mask 全 1 取 a，全 0 取 b
+double blend(std::uint64_t mask, double a, double b) {
+    std::uint64_t a_bits, b_bits;
+    std::memcpy(&a_bits, &a, sizeof(a));
+    std::memcpy(&b_bits, &b, sizeof(b));
+    std::uint64_t bits = (a_bits & mask) | (b_bits & ~mask);
+    double result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+// 条件为真（非零）时得到全 1 掩码
+std::uint64_t truthMask(double condition) {
+    return ~static_cast<std::uint64_t>(0) * static_cast<std::uint64_t>(condition != 0.0);
+}
+
+double applyUnary(OpCode op, double a) {
+    switch (op) {
+        case OpCode::POW_HALF: return powHalf(a);
+        case OpCode::NEG:      return -a;
+        case OpCode::SQRT:     return std::sqrt(a);
+        case OpCode::SIN:      return std::sin(a);
+        case OpCode::COS:      return std::cos(a);
+        case OpCode::TAN:      return std::tan(a);
+        case OpCode::LOG:      return std::log(a);
+        case OpCode::EXP:      return std::exp(a);
+        default:
+            throw std::runtime_error("未知的程序指令");
+    }
+}
+
+// 运算自身产生的错误（操作数均无错误时）
+EvalError localError(OpCode op, double a, double b) {
+    switch (op) {
+        case OpCode::DIV:  return b == 0.0 ? EvalError::DIVISION_BY_ZERO : EvalError::NONE;
+        case OpCode::SQRT: return a < 0.0 ? EvalError::NEGATIVE_SQRT : EvalError::NONE;
+        case OpCode::LOG:  return a <= 0.0 ? EvalError::LOG_DOMAIN : EvalError::NONE;
+        default:           return EvalError::NONE;
+    }
+}
+
+// 操作数中按求值顺序的第一个错误
+EvalError firstError(EvalError a, EvalError b, EvalError c) {
+    return a != EvalError::NONE ? a : (b != EvalError::NONE ? b : c);
+}
+
+double applyBinary(OpCode op, double a, double b) {
+    switch (op) {
+        case OpCode::ADD: return a + b;
+        case OpCode::SUB: return a - b;
+        case OpCode::MUL: return a * b;
+        case OpCode::DIV: return a / b;
+        case OpCode::POW: return std::pow(a, b);
+        case OpCode::LT:  return static_cast<double>(a < b);
+        case OpCode::LE:  return static_cast<double>(a <= b);
+        case OpCode::GT:  return static_cast<double>(a > b);
+        case OpCode::GE:  return static_cast<double>(a >= b);
+        case OpCode::EQ:  return static_cast<double>(a == b);
+        case OpCode::NE:  return static_cast<double>(a != b);
+        case OpCode::AND: return static_cast<double>((a != 0.0) & (b != 0.0));
+        case OpCode::OR:  return static_cast<double>((a != 0.0) | (b != 0.0));
+        default:
+            throw std::runtime_error("未知的程序指令");
+    }
+}
+
+// 计算缓冲区。归约指令会在计算过程中重入 Program 的计算函数，
+// 因此每一层调用都从线程局部的缓冲区栈中租用独立的一份。
+struct Scratch {
+    std::vector<double> storage;
+    std::vector<double> constants;
+    std::vector<const double*> views;
+    std::vector<double> outer;
+    // 受检计算时与 storage/views 平行的错误缓冲
+    std::vector<EvalError> error_storage;
+    std::vector<const EvalError*> error_views;
+};
+
+thread_local std::vector<std::unique_ptr<Scratch>> scratch_pool;
+thread_local size_t scratch_depth = 0;
+
+class ScratchLease {
+private:
+    Scratch* scratch;
+    
+public:
+    ScratchLease() {
+        if (scratch_depth == scratch_pool.size()) {
+            scratch_pool.push_back(std::make_unique<Scratch>());
+        }
+        scratch = scratch_pool[scratch_depth++].get();
+    }
+    ~ScratchLease() { scratch_depth--; }
+    ScratchLease(const ScratchLease&) = delete;
+    ScratchLease& operator=(const ScratchLease&) = delete;
+    
+    Scratch* operator->() const { return scratch; }
+};
+
+} // namespace
+
+int operandCount(OpCode op) {
+    switch (op) {
+        case OpCode::CONST:
+        case OpCode::INPUT:
+            return 0;
+        case OpCode::ADD:
+        case OpCode::SUB:
+        case OpCode::MUL:
+        case OpCode::DIV:
+        case OpCode::POW:
+        case OpCode::LT:
+        case OpCode::LE:
+        case OpCode::GT:
+        case OpCode::GE:
+        case OpCode::EQ:
+        case OpCode::NE:
+        case OpCode::AND:
+        case OpCode::OR:
+        case OpCode::REDUCE:
+            return 2;
+        case OpCode::SELECT:
+            return 3;
+        default:
+            return 1;
+    }
+}
+
+void Program::evaluate(const double* inputs, double* results) const {
+    ScratchLease scratch;
+    scratch->storage.resize(code.size());
+    double* r = scratch->storage.data();
+    
+    for (size_t i = 0; i < code.size(); i++) {
+        const Instruction& ins = code[i];
+        switch (ins.op) {
+            case OpCode::CONST: r[i] = ins.imm; break;
+            case OpCode::INPUT: r[i] = inputs[ins.a]; break;
+            case OpCode::ADD:   r[i] = r[ins.a] + r[ins.b]; break;
+            case OpCode::SUB:   r[i] = r[ins.a] - r[ins.b]; break;
+            case OpCode::MUL:   r[i] = r[ins.a] * r[ins.b]; break;
+            case OpCode::DIV:   r[i] = r[ins.a] / r[ins.b]; break;
+            case OpCode::POW:   r[i] = std::pow(r[ins.a], r[ins.b]); break;
+            case OpCode::SELECT:
+                r[i] = blend(truthMask(r[ins.a]), r[ins.b], r[ins.c]);
+                break;
+            case OpCode::REDUCE: {
+                const Reduction& reduction = reductions[ins.c];
+                scratch->outer.resize(reduction.outer.size());
+                for (size_t j = 0; j < reduction.outer.size(); j++) {
+                    scratch->outer[j] = r[reduction.outer[j]];
+                }
+                r[i] = reduceRange(reduction.kind, *reduction.body, r[ins.a], r[ins.b], scratch->outer.data());
+                break;
+            }
+            default:
+                r[i] = operandCount(ins.op) == 2 ? applyBinary(ins.op, r[ins.a], r[ins.b])
+                                                 : applyUnary(ins.op, r[ins.a]);
+                break;
+        }
+    }
+    
+    for (size_t j = 0; j < outputs.size(); j++) {
+        results[j] = r[outputs[j]];
+    }
+}
+
+void Program::evaluateBatch(const double* const* input_columns, size_t rows,
+                            double* const* output_columns) const {
+    evaluateBlocks(input_columns, rows, output_columns, nullptr);
+}
+
+void Program::evaluateBatchChecked(const double* const* input_columns, size_t rows,
+                                   double* const* output_columns, EvalError* row_errors) const {
+    evaluateBlocks(input_columns, rows, output_columns, row_errors);
+}
+
+void Program::evaluateBlocks(const double* const* input_columns, size_t rows,
+                             double* const* output_columns, EvalError* row_errors) const {
+    ScratchLease scratch;
+    std::vector<double>& storage = scratch->storage;
+    std::vector<double>& constants = scratch->constants;
+    std::vector<const double*>& views = scratch->views;
+    storage.resize(static_cast<size_t>(slot_count) * BLOCK_SIZE);
+    views.assign(code.size(), nullptr);
+    
+    // 常量在整个批次内不变，只填充一次
+    size_t constant_count = std::count_if(code.begin(), code.end(),
+        [](const Instruction& ins) { return ins.op == OpCode::CONST; });
+    constants.resize(constant_count * BLOCK_SIZE);
+    double* next_constant = constants.data();
+    for (size_t i = 0; i < code.size(); i++) {
+        if (code[i].op == OpCode::CONST) {
+            std::fill_n(next_constant, BLOCK_SIZE, code[i].imm);
+            views[i] = next_constant;
+            next_constant += BLOCK_SIZE;
+        }
+    }
+    
+    // 常量与输入没有错误，共用一段全 NONE 的缓冲
+    std::vector<EvalError>& error_storage = scratch->error_storage;
+    std::vector<const EvalError*>& error_views = scratch->error_views;
+    if (row_errors) {
+        error_storage.assign(static_cast<size_t>(slot_count + 1) * BLOCK_SIZE, EvalError::NONE);
+        error_views.assign(code.size(), error_storage.data() + static_cast<size_t>(slot_count) * BLOCK_SIZE);
+    }
+    
+    for (size_t base = 0; base < rows; base += BLOCK_SIZE) {
+        const size_t n = std::min(BLOCK_SIZE, rows - base);
+        
+        for (size_t i = 0; i < code.size(); i++) {
+            const Instruction& ins = code[i];
+            if (ins.op == OpCode::CONST) {
+                continue;
+            }
+            if (ins.op == OpCode::INPUT) {
+                // 输入直接引用原始列，无需拷贝
+                views[i] = input_columns[ins.a] + base;
+                continue;
+            }
+            
+            double* out = storage.data() + static_cast<size_t>(slots[i]) * BLOCK_SIZE;
+            const double* x = views[ins.a];
+            const int operands = operandCount(ins.op);
+            const double* y = operands >= 2 ? views[ins.b] : nullptr;
+            const double* z = operands >= 3 ? views[ins.c] : nullptr;
+            
+            // 错误必须先于结果计算：结果可能复用操作数的缓冲槽，覆盖条件值
+            EvalError* e = nullptr;
+            if (row_errors) {
+                e = error_storage.data() + static_cast<size_t>(slots[i]) * BLOCK_SIZE;
+                const EvalError* ex = error_views[ins.a];
+                const EvalError* ey = operands >= 2 ? error_views[ins.b] : ex;
+                const EvalError* ez = operands >= 3 ? error_views[ins.c] : ex;
+                switch (ins.op) {
+                    case OpCode::SELECT:
+                        for (size_t k = 0; k < n; k++) {
+                            e[k] = firstError(ex[k], x[k] != 0.0 ? ey[k] : ez[k], EvalError::NONE);
+                        }
+                        break;
+                    case OpCode::AND:
+                        for (size_t k = 0; k < n; k++) {
+                            e[k] = firstError(ex[k], x[k] != 0.0 ? ey[k] : EvalError::NONE, EvalError::NONE);
+                        }
+                        break;
+                    case OpCode::OR:
+                        for (size_t k = 0; k < n; k++) {
+                            e[k] = firstError(ex[k], x[k] != 0.0 ? EvalError::NONE : ey[k], EvalError::NONE);
+                        }
+                        break;
+                    default:
+                        // 归约体的错误在下面计算归约时追加
+                        for (size_t k = 0; k < n; k++) {
+                            e[k] = firstError(ex[k], ey[k], localError(ins.op, x[k], y ? y[k] : 0.0));
+                        }
+                        break;
+                }
+                error_views[i] = e;
+            }
+            
+            switch (ins.op) {
+                case OpCode::ADD:
+                    for (size_t k = 0; k < n; k++) out[k] = x[k] + y[k];
+                    break;
+                case OpCode::SUB:
+                    for (size_t k = 0; k < n; k++) out[k] = x[k] - y[k];
+                    break;
+                case OpCode::MUL:
+                    for (size_t k = 0; k < n; k++) out[k] = x[k] * y[k];
+                    break;
+                case OpCode::DIV:
+                    for (size_t k = 0; k < n; k++) out[k] = x[k] / y[k];
+                    break;
+                case OpCode::POW:
+                    for (size_t k = 0; k < n; k++) out[k] = std::pow(x[k], y[k]);
+                    break;
+                case OpCode::NEG:
+                    for (size_t k = 0; k < n; k++) out[k] = -x[k];
+                    break;
+                case OpCode::SQRT:
+                    for (size_t k = 0; k < n; k++) out[k] = std::sqrt(x[k]);
+                    break;
+                case OpCode::LT:
+                    for (size_t k = 0; k < n; k++) out[k] = static_cast<double>(x[k] < y[k]);
+                    break;
+                case OpCode::LE:
+                    for (size_t k = 0; k < n; k++) out[k] = static_cast<double>(x[k] <= y[k]);
+                    break;
+                case OpCode::GT:
+                    for (size_t k = 0; k < n; k++) out[k] = static_cast<double>(x[k] > y[k]);
+                    break;
+                case OpCode::GE:
+                    for (size_t k = 0; k < n; k++) out[k] = static_cast<double>(x[k] >= y[k]);
+                    break;
+                case OpCode::SELECT:
+                    // 掩码混合代替分支，条件混杂时不会产生分支预测失败
+                    for (size_t k = 0; k < n; k++) out[k] = blend(truthMask(x[k]), y[k], z[k]);
+                    break;
+                case OpCode::REDUCE: {
+                    const Reduction& reduction = reductions[ins.c];
+                    scratch->outer.resize(reduction.outer.size());
+                    for (size_t k = 0; k < n; k++) {
+                        for (size_t j = 0; j < reduction.outer.size(); j++) {
+                            scratch->outer[j] = views[reduction.outer[j]][k];
+                        }
+                        // 区间端点先于归约体求值，端点已出错时保留端点的错误
+                        EvalError nested = EvalError::NONE;
+                        out[k] = reduceRange(reduction.kind, *reduction.body, x[k], y[k], scratch->outer.data(),
+                                             e ? &nested : nullptr);
+                        if (e && e[k] == EvalError::NONE) {
+                            e[k] = nested;
+                        }
+                    }
+                    break;
+                }
+                default:
+                    if (operands == 2) {
+                        for (size_t k = 0; k < n; k++) out[k] = applyBinary(ins.op, x[k], y[k]);
+                    } else {
+                        for (size_t k = 0; k < n; k++) out[k] = applyUnary(ins.op, x[k]);
+                    }
+                    break;
+            }
+            views[i] = out;
+        }
+        
+        for (size_t j = 0; j < outputs.size(); j++) {
+            std::memcpy(output_columns[j] + base, views[outputs[j]], n * sizeof(double));
+        }
+        if (row_errors) {
+            for (size_t k = 0; k < n; k++) {
+                EvalError error = EvalError::NONE;
+                for (size_t j = 0; j < outputs.size() && error == EvalError::NONE; j++) {
+                    error = error_views[outputs[j]][k];
+                }
+                row_errors[base + k] = error;
+            }
+        }
+    }
+}
+
+void Program::assignSlots() {
+    // 计算每个寄存器最后一次被读取的位置，之后其缓冲槽可被复用
+    std::vector<size_t> last_use(code.size(), 0);
+    for (size_t i = 0; i < code.size(); i++) {
+        const Instruction& ins = code[i];
+        if (ins.op == OpCode::CONST || ins.op == OpCode::INPUT) {
+            continue;
+        }
+        const int operands = operandCount(ins.op);
+        last_use[ins.a] = i;
+        if (operands >= 2) {
+            last_use[ins.b] = i;
+        }
+        if (operands >= 3) {
+            last_use[ins.c] = i;
+        }
+        if (ins.op == OpCode::REDUCE) {
+            for (int reg : reductions[ins.c].outer) {
+                last_use[reg] = i;
+            }
+        }
+    }
+    for (int reg : outputs) {
+        last_use[reg] = code.size();
+    }
+    
+    slots.assign(code.size(), -1);
+    slot_count = 0;
+    std::vector<int> free_slots;
+    for (size_t i = 0; i < code.size(); i++) {
+        const Instruction& ins = code[i];
+        if (ins.op == OpCode::CONST || ins.op == OpCode::INPUT) {
+            continue;
+        }
+        
+        // 逐元素计算时结果可以写回操作数的缓冲槽，因此先释放再分配
+        const int count = operandCount(ins.op);
+        std::vector<int> operands = {ins.a, count >= 2 ? ins.b : -1, count >= 3 ? ins.c : -1};
+        if (ins.op == OpCode::REDUCE) {
+            operands.insert(operands.end(), reductions[ins.c].outer.begin(), reductions[ins.c].outer.end());
+        }
+        for (int operand : operands) {
+            if (operand >= 0 && last_use[operand] == i && slots[operand] >= 0) {
+                if (std::find(free_slots.begin(), free_slots.end(), slots[operand]) == free_slots.end()) {
+                    free_slots.push_back(slots[operand]);
+                }
+            }
+        }
+        
+        if (!free_slots.empty()) {
+            slots[i] = free_slots.back();
+            free_slots.pop_back();
+        } else {
+            slots[i] = slot_count++;
+        }
+    }
+}
+
+ProgramBuilder::ProgramBuilder(const std::vector<std::string>& inputs) : fixed_inputs(true) {
+    for (const auto& name : inputs) {
+        if (input_index.count(name)) {
+            throw std::runtime_error("重复的输入变量：" + name);
+        }
+        input_index[name] = static_cast<int>(program.variables.size());
+        program.variables.push_back(name);
+    }
+}
+
+int ProgramBuilder::emit(const Instruction& instruction) {
+    Instruction ins = instruction;
+    if (isCommutative(ins.op) && ins.a > ins.b) {
+        std::swap(ins.a, ins.b);
+    }
+    
+    // 以操作码、操作数和常量的位模式作为合并键
+    char key[sizeof(ins.op) + sizeof(ins.a) + sizeof(ins.b) + sizeof(ins.c) + sizeof(ins.imm)];
+    char* p = key;
+    std::memcpy(p, &ins.op, sizeof(ins.op)); p += sizeof(ins.op);
+    std::memcpy(p, &ins.a, sizeof(ins.a));   p += sizeof(ins.a);
+    std::memcpy(p, &ins.b, sizeof(ins.b));   p += sizeof(ins.b);
+    std::memcpy(p, &ins.c, sizeof(ins.c));   p += sizeof(ins.c);
+    std::memcpy(p, &ins.imm, sizeof(ins.imm));
+    
+    auto inserted = instruction_index.emplace(std::string(key, sizeof(key)),
+                                              static_cast<int>(program.code.size()));
+    if (!inserted.second) {
+        // 重复的常量与输入引用不算共享计算
+        if (ins.op != OpCode::CONST && ins.op != OpCode::INPUT) {
+            shared_count++;
+        }
+        return inserted.first->second;
+    }
+    program.code.push_back(ins);
+    return inserted.first->second;
+}
+
+int ProgramBuilder::constant(double value) {
+    return emit({OpCode::CONST, 0, 0, 0, value});
+}
+
+int ProgramBuilder::input(const std::string& name) {
+    auto it = input_index.find(name);
+    if (it == input_index.end()) {
+        if (fixed_inputs) {
+            throw std::runtime_error("未定义的变量：" + name);
+        }
+        it = input_index.emplace(name, static_cast<int>(program.variables.size())).first;
+        program.variables.push_back(name);
+    }
+    return emit({OpCode::INPUT, it->second, 0, 0, 0.0});
+}
+
+int ProgramBuilder::unary(OpCode op, int a) {
+    return emit({op, a, 0, 0, 0.0});
+}
+
+int ProgramBuilder::binary(OpCode op, int a, int b) {
+    return emit({op, a, b, 0, 0.0});
+}
+
+int ProgramBuilder::select(int condition, int when_true, int when_false) {
+    // 两个分支相同时无需选择
+    if (when_true == when_false) {
+        return when_true;
+    }
+    return emit({OpCode::SELECT, condition, when_true, when_false, 0.0});
+}
+
+int ProgramBuilder::reduce(ReductionKind kind, std::shared_ptr<const Program> body, int lo, int hi,
+                           const std::vector<int>& outer) {
+    program.reductions.push_back({kind, std::move(body), outer});
+    return emit({OpCode::REDUCE, lo, hi, static_cast<int>(program.reductions.size() - 1), 0.0});
+}
+
+void ProgramBuilder::addOutput(int reg) {
+    program.outputs.push_back(reg);
+}
+
+Program ProgramBuilder::build() {
+    program.assignSlots();
+    Program result = std::move(program);
+    program = Program();
+    input_index.clear();
+    instruction_index.clear();
+    return result;
+}
+
+namespace {
+
+// 序列化格式版本，格式变化时递增
+constexpr std::uint32_t SERIALIZE_VERSION = 3;
+
+template <typename T>
+void writeValue(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void writeString(std::string& out, const std::string& text) {
+    writeValue<std::uint32_t>(out, static_cast<std::uint32_t>(text.size()));
+    out.append(text);
+}
+
+class ByteReader {
+private:
+    const std::string& bytes;
+    size_t position = 0;
+    
+public:
+    explicit ByteReader(const std::string& data) : bytes(data) {}
+    
+    template <typename T>
+    T read() {
+        T value;
+        if (bytes.size() - position < sizeof(value)) {
+            throw std::runtime_error("程序数据不完整");
+        }
+        std::memcpy(&value, bytes.data() + position, sizeof(value));
+        position += sizeof(value);
+        return value;
+    }
+    
+    std::string readString() {
+        std::uint32_t length = read<std::uint32_t>();
+        if (bytes.size() - position < length) {
+            throw std::runtime_error("程序数据不完整");
+        }
+        std::string text = bytes.substr(position, length);
+        position += length;
+        return text;
+    }
+    
+    bool atEnd() const { return position == bytes.size(); }
+};
+
+} // namespace
+
+std::string Program::serialize() const {
+    std::string out;
+    writeValue(out, SERIALIZE_VERSION);
+    
+    writeValue<std::uint32_t>(out, static_cast<std::uint32_t>(variables.size()));
+    for (const auto& name : variables) {
+        writeString(out, name);
+    }
+    
+    writeValue<std::uint32_t>(out, static_cast<std::uint32_t>(reductions.size()));
+    for (const auto& reduction : reductions) {
+        writeValue(out, reduction.kind);
+        writeValue<std::uint32_t>(out, static_cast<std::uint32_t>(reduction.outer.size()));
+        for (int reg : reduction.outer) {
+            writeValue<std::int32_t>(out, reg);
+        }
+        writeString(out, reduction.body->serialize());
+    }
+    
+    writeValue<std::uint32_t>(out, static_cast<std::uint32_t>(code.size()));
+    for (const auto& ins : code) {
+        writeValue(out, ins.op);
+        writeValue<std::int32_t>(out, ins.a);
+        writeValue<std::int32_t>(out, ins.b);
+        writeValue<std::int32_t>(out, ins.c);
+        writeValue(out, ins.imm);
+    }
+    
+    writeValue<std::uint32_t>(out, static_cast<std::uint32_t>(outputs.size()));
+    for (int reg : outputs) {
+        writeValue<std::int32_t>(out, reg);
+    }
+    return out;
+}
+
+Program Program::deserialize(const std::string& bytes) {
+    ByteReader reader(bytes);
+    if (reader.read<std::uint32_t>() != SERIALIZE_VERSION) {
+        throw std::runtime_error("程序数据版本不匹配");
+    }
+    
+    Program program;
+    std::uint32_t variable_count = reader.read<std::uint32_t>();
+    for (std::uint32_t i = 0; i < variable_count; i++) {
+        program.variables.push_back(reader.readString());
+    }
+    
+    std::uint32_t reduction_count = reader.read<std::uint32_t>();
+    for (std::uint32_t i = 0; i < reduction_count; i++) {
+        Reduction reduction;
+        reduction.kind = reader.read<ReductionKind>();
+        if (reduction.kind > ReductionKind::MAX) {
+            throw std::runtime_error("程序数据损坏：未知的归约类型");
+        }
+        std::uint32_t outer_count = reader.read<std::uint32_t>();
+        for (std::uint32_t k = 0; k < outer_count; k++) {
+            reduction.outer.push_back(reader.read<std::int32_t>());
+        }
+        reduction.body = std::make_shared<const Program>(deserialize(reader.readString()));
+        if (reduction.body->variables.size() != reduction.outer.size() + 1 ||
+            reduction.body->outputs.size() != 1) {
+            throw std::runtime_error("程序数据损坏：归约体与外层变量不匹配");
+        }
+        program.reductions.push_back(std::move(reduction));
+    }
+    
+    // 逐条校验：SSA 操作数只能引用之前的寄存器
+    std::uint32_t code_size = reader.read<std::uint32_t>();
+    for (std::uint32_t i = 0; i < code_size; i++) {
+        Instruction ins;
+        ins.op = reader.read<OpCode>();
+        ins.a = reader.read<std::int32_t>();
+        ins.b = reader.read<std::int32_t>();
+        ins.c = reader.read<std::int32_t>();
+        ins.imm = reader.read<double>();
+        
+        const int reg = static_cast<int>(i);
+        auto valid = [reg](int operand) { return operand >= 0 && operand < reg; };
+        bool ok = ins.op <= OpCode::REDUCE;
+        if (ok && ins.op == OpCode::INPUT) {
+            ok = ins.a >= 0 && ins.a < static_cast<int>(variable_count);
+        } else if (ok && ins.op != OpCode::CONST) {
+            const int operands = operandCount(ins.op);
+            ok = valid(ins.a) && (operands < 2 || valid(ins.b)) && (operands < 3 || valid(ins.c));
+            if (ok && ins.op == OpCode::REDUCE) {
+                ok = ins.c >= 0 && ins.c < static_cast<int>(reduction_count);
+                for (size_t k = 0; ok && k < program.reductions[ins.c].outer.size(); k++) {
+                    ok = valid(program.reductions[ins.c].outer[k]);
+                }
+            }
+        }
+        if (!ok) {
+            throw std::runtime_error("程序数据损坏：指令 " + std::to_string(i) + " 无效");
+        }
+        program.code.push_back(ins);
+    }
+    
+    std::uint32_t output_count = reader.read<std::uint32_t>();
+    for (std::uint32_t i = 0; i < output_count; i++) {
+        int reg = reader.read<std::int32_t>();
+        if (reg < 0 || reg >= static_cast<int>(code_size)) {
+            throw std::runtime_error("程序数据损坏：输出寄存器越界");
+        }
+        program.outputs.push_back(reg);
+    }
+    if (!reader.atEnd()) {
+        throw std::runtime_error("程序数据损坏：存在多余数据");
+    }
+    
+    program.assignSlots();
+    return program;
+}
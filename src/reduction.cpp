@@ -0,0 +1,273 @@
+#include "reduction.h"
+#include "parser.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<unsigned int> configured_threads{0};
+
+// 工作线程内部的嵌套归约串行执行，避免线程数量爆炸
+thread_local bool inside_worker = false;
+
+// 块的部分结果：求和时 value 为和，compensation 为 Neumaier 补偿项
+struct Partial {
+    double value;
+    double compensation;
+    bool has_nan;
+    EvalError error;  // 块内索引最小的出错项的错误（仅受检计算）
+};
+
+double identity(ReductionKind kind) {
+    switch (kind) {
+        case ReductionKind::SUM:  return 0.0;
+        case ReductionKind::PROD: return 1.0;
+        case ReductionKind::MIN:  return std::numeric_limits<double>::infinity();
+        case ReductionKind::MAX:  return -std::numeric_limits<double>::infinity();
+    }
+    return 0.0;
+}
+
+// Neumaier 补偿加法：把 term 加到 sum 上，丢失的低位累计到 compensation
+inline void compensatedAdd(double& sum, double& compensation, double term) {
+    double t = sum + term;
+    // 和溢出为 inf 或出现 NaN 后补偿项已无意义，保持其有限以免把 inf 变成 NaN
+    if (std::isfinite(t)) {
+        if (std::fabs(sum) >= std::fabs(term)) {
+            compensation += (sum - t) + term;
+        } else {
+            compensation += (term - t) + sum;
+        }
+    }
+    sum = t;
+}
+
+void accumulate(ReductionKind kind, Partial& partial, const double* values, size_t n) {
+    for (size_t k = 0; k < n; k++) {
+        double v = values[k];
+        switch (kind) {
+            case ReductionKind::SUM:
+                compensatedAdd(partial.value, partial.compensation, v);
+                break;
+            case ReductionKind::PROD:
+                partial.value *= v;
+                break;
+            case ReductionKind::MIN:
+                if (std::isnan(v)) partial.has_nan = true;
+                else if (v < partial.value) partial.value = v;
+                break;
+            case ReductionKind::MAX:
+                if (std::isnan(v)) partial.has_nan = true;
+                else if (v > partial.value) partial.value = v;
+                break;
+        }
+    }
+}
+
+// 逐块计算：每个工作者持有自己的索引列、外部变量列与结果缓冲
+class ChunkWorker {
+private:
+    const Program& body;
+    ReductionKind kind;
+    double lo;
+    std::vector<double> index;
+    std::vector<std::vector<double>> outer;
+    std::vector<const double*> inputs;
+    std::vector<double> result;
+    std::vector<EvalError> errors;
+    
+public:
+    ChunkWorker(const Program& program, ReductionKind reduction_kind, double start,
+                const double* outer_values)
+        : body(program), kind(reduction_kind), lo(start),
+          index(REDUCTION_CHUNK), result(REDUCTION_CHUNK) {
+        size_t outer_count = body.inputNames().size() - 1;
+        inputs.push_back(index.data());
+        for (size_t j = 0; j < outer_count; j++) {
+            outer.emplace_back(REDUCTION_CHUNK, outer_values[j]);
+        }
+        for (auto& column : outer) {
+            inputs.push_back(column.data());
+        }
+    }
+    
+    Partial run(std::uint64_t first, size_t n, bool checked) {
+        for (size_t k = 0; k < n; k++) {
+            index[k] = lo + static_cast<double>(first + k);
+        }
+        double* outputs[] = {result.data()};
+        Partial partial = {identity(kind), 0.0, false, EvalError::NONE};
+        if (checked) {
+            errors.resize(REDUCTION_CHUNK);
+            body.evaluateBatchChecked(inputs.data(), n, outputs, errors.data());
+            auto failed = std::find_if(errors.begin(), errors.begin() + n,
+                                       [](EvalError e) { return e != EvalError::NONE; });
+            if (failed != errors.begin() + n) {
+                partial.error = *failed;
+                return partial;
+            }
+        } else {
+            body.evaluateBatch(inputs.data(), n, outputs);
+        }
+        
+        accumulate(kind, partial, result.data(), n);
+        return partial;
+    }
+};
+
+} // namespace
+
+void setReductionThreads(unsigned int threads) {
+    configured_threads = threads;
+}
+
+unsigned int reductionThreads() {
+    unsigned int threads = configured_threads;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return threads;
+}
+
+double reduceRange(ReductionKind kind, const Program& body, double lo, double hi, const double* outer_values,
+                   EvalError* error) {
+    const bool checked = error != nullptr;
+    if (checked) {
+        *error = EvalError::NONE;
+    }
+    if (!std::isfinite(lo) || !std::isfinite(hi)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (hi < lo) {
+        return identity(kind);
+    }
+    double span = std::floor(hi - lo);
+    if (span >= 9007199254740992.0) {  // 2^53 项以上无法逐项精确表示索引
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    
+    const std::uint64_t count = static_cast<std::uint64_t>(span) + 1;
+    const size_t chunks = static_cast<size_t>((count + REDUCTION_CHUNK - 1) / REDUCTION_CHUNK);
+    std::vector<Partial> partials(chunks);
+    
+    auto chunkSize = [count](size_t chunk) {
+        std::uint64_t first = static_cast<std::uint64_t>(chunk) * REDUCTION_CHUNK;
+        return static_cast<size_t>(std::min<std::uint64_t>(REDUCTION_CHUNK, count - first));
+    };
+    
+    unsigned int threads = inside_worker || count < REDUCTION_PARALLEL_THRESHOLD
+        ? 1u : static_cast<unsigned int>(std::min<size_t>(reductionThreads(), chunks));
+    
+    // 受检计算时，编号大于已知出错块的块不再计算
+    std::atomic<size_t> error_chunk{chunks};
+    
+    if (threads <= 1) {
+        ChunkWorker worker(body, kind, lo, outer_values);
+        for (size_t c = 0; c < chunks; c++) {
+            partials[c] = worker.run(static_cast<std::uint64_t>(c) * REDUCTION_CHUNK, chunkSize(c), checked);
+            if (partials[c].error != EvalError::NONE) {
+                break;
+            }
+        }
+    } else {
+        // 动态领取块，部分结果按块编号存放，合并顺序固定
+        std::atomic<size_t> next_chunk{0};
+        auto work = [&]() {
+            inside_worker = true;
+            ChunkWorker worker(body, kind, lo, outer_values);
+            for (size_t c = next_chunk++; c < chunks; c = next_chunk++) {
+                if (c > error_chunk) {
+                    continue;
+                }
+                partials[c] = worker.run(static_cast<std::uint64_t>(c) * REDUCTION_CHUNK, chunkSize(c), checked);
+                if (partials[c].error != EvalError::NONE) {
+                    size_t known = error_chunk;
+                    while (c < known && !error_chunk.compare_exchange_weak(known, c)) {
+                    }
+                }
+            }
+            inside_worker = false;
+        };
+        
+        std::vector<std::thread> pool;
+        for (unsigned int t = 1; t < threads; t++) {
+            pool.emplace_back(work);
+        }
+        work();
+        for (auto& thread : pool) {
+            thread.join();
+        }
+    }
+    
+    if (checked) {
+        for (const Partial& partial : partials) {
+            if (partial.error != EvalError::NONE) {
+                *error = partial.error;
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+        }
+    }
+    
+    // 按块顺序合并
+    Partial total = {identity(kind), 0.0, false, EvalError::NONE};
+    for (const Partial& partial : partials) {
+        switch (kind) {
+            case ReductionKind::SUM:
+                compensatedAdd(total.value, total.compensation, partial.value);
+                compensatedAdd(total.value, total.compensation, partial.compensation);
+                break;
+            case ReductionKind::PROD:
+                total.value *= partial.value;
+                break;
+            case ReductionKind::MIN:
+                total.value = std::min(total.value, partial.value);
+                break;
+            case ReductionKind::MAX:
+                total.value = std::max(total.value, partial.value);
+                break;
+        }
+        total.has_nan = total.has_nan || partial.has_nan;
+    }
+    
+    if (total.has_nan) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return kind == ReductionKind::SUM ? total.value + total.compensation : total.value;
+}
+
+double ReductionNode::evaluate() {
+    double lo = lower->evaluate();
+    double hi = upper->evaluate();
+    
+    std::shared_ptr<const Program> program = bodyProgram();
+    const auto& names = program->inputNames();
+    if (names.size() > 1) {
+        throw std::runtime_error("未定义的变量：" + names[1]);
+    }
+    
+    ReductionKind kind = ReductionKind::SUM;
+    switch (reduction_type) {
+        case TokenType::SUM:  kind = ReductionKind::SUM; break;
+        case TokenType::PROD: kind = ReductionKind::PROD; break;
+        case TokenType::MIN:  kind = ReductionKind::MIN; break;
+        case TokenType::MAX:  kind = ReductionKind::MAX; break;
+        default:
+            throw std::runtime_error("未知的归约操作");
+    }
+    
+    // 树求值器遇到除零或定义域错误时抛出异常，归约体也应如此，而不是得到 inf/NaN
+    EvalError error = EvalError::NONE;
+    double result = reduceRange(kind, *program, lo, hi, nullptr, &error);
+    switch (error) {
+        case EvalError::DIVISION_BY_ZERO: throw std::runtime_error("除零错误");
+        case EvalError::NEGATIVE_SQRT:    throw std::runtime_error("负数不能开平方根");
+        case EvalError::LOG_DOMAIN:       throw std::runtime_error("对数函数的参数必须为正数");
+        case EvalError::NONE:             break;
+    }
+    return result;
+}
@@ -1,7 +1,606 @@
 #include "calculator.h"
+#include "optimizer.h"
+#include "formula_bundle.h"
+#include "column_stream.h"
+#include "reduction.h"
+#include "persistent_cache.h"
+#include "compiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <string>
+#include <thread>
+
+// 输出单项测试结果，返回是否通过
+bool report(const std::string& label, double expected, double got) {
+    bool passed = std::abs(got - expected) < 0.001;
+    std::cout << "Expression: " << label << std::endl;
+    std::cout << "Expected: " << expected << std::endl;
+    std::cout << "Got: " << got << std::endl;
+    std::cout << "Status: " << (passed ? "PASS" : "FAIL") << std::endl;
+    std::cout << "--------------------" << std::endl;
+    return passed;
+}
+
+// 输出异常测试结果
+void reportError(const std::string& label, const std::exception& e) {
+    std::cout << "Expression: " << label << std::endl;
+    std::cout << "Error: " << e.what() << std::endl;
+    std::cout << "Status: FAIL" << std::endl;
+    std::cout << "--------------------" << std::endl;
+}
+
+// 两个同号有限 double 之间相隔的 ulp 数
+std::int64_t ulpDistance(double a, double b) {
+    std::int64_t ia = 0;
+    std::int64_t ib = 0;
+    std::memcpy(&ia, &a, sizeof(a));
+    std::memcpy(&ib, &b, sizeof(b));
+    return ia > ib ? ia - ib : ib - ia;
+}
+
+// 强度削减测试：检查节点确实被改写，而不仅是结果正确
+bool testStrengthReduction() {
+    bool allPassed = true;
+    std::cout << "\nStrength Reduction Tests:" << std::endl;
+    std::cout << "====================================" << std::endl;
+    
+    auto optimized = [](const std::string& expression) {
+        Lexer lexer(expression);
+        Parser parser(lexer.tokenize());
+        return optimizeAST(parser.parse());
+    };
+    auto check = [&allPassed](const std::string& label, const std::string& expected, const std::string& got) {
+        bool passed = got == expected;
+        std::cout << "Expression: " << label << std::endl;
+        std::cout << "Expected: " << expected << std::endl;
+        std::cout << "Got: " << got << std::endl;
+        std::cout << "Status: " << (passed ? "PASS" : "FAIL") << std::endl;
+        std::cout << "--------------------" << std::endl;
+        allPassed &= passed;
+    };
+    
+    try {
+        check("x^3", "IntPowerNode(^3)", optimized("x^3")->describe());
+        check("x^5", "BinaryOpNode(^)", optimized("x^5")->describe());
+        // 负指数保留 std::pow，但带符号的指数仍折叠为常量
+        auto negative = optimized("x^-2");
+        check("x^-2", "BinaryOpNode(^)", negative->describe());
+        check("x^-2 (constant)", "NumberNode(-2)", negative->child(1)->describe());
+        auto division = optimized("x / -4");
+        check("x / -4", "BinaryOpNode(*)", division->describe());
+        check("x / -4 (constant)", "NumberNode(-0.25)", division->child(1)->describe());
+        check("-(-5)", "NumberNode(5)", optimized("-(-5)")->describe());
+        
+        // int64 路径只在整棵树都是整数运算时尝试
+        allPassed &= report("integer-only 2^10 - 3 * 4", 1.0, optimized("2^10 - 3 * 4")->isIntegerOnly() ? 1.0 : 0.0);
+        allPassed &= report("integer-only (2^3*5+7)*1.5", 0.0,
+                            optimized("(2^3*5+7)*1.5")->isIntegerOnly() ? 1.0 : 0.0);
+        allPassed &= report("integer-only 2^64 / 2^60", 0.0, optimized("2^64 / 2^60")->isIntegerOnly() ? 1.0 : 0.0);
+        
+        // 乘法链与 std::pow 相差不超过 2 ulp（树求值与编译后的程序）
+        ProgramBuilder builder;
+        for (int n = 0; n <= MAX_INT_POWER_EXPONENT; n++) {
+            builder.addOutput(compileExpression(builder, "x^" + std::to_string(n)));
+        }
+        Program powers = builder.build();
+        std::vector<double> program_out(MAX_INT_POWER_EXPONENT + 1);
+        std::int64_t worst = 0;
+        unsigned int seed = 2024;
+        for (int i = 0; i < 20000; i++) {
+            seed = seed * 1103515245u + 12345u;
+            double mantissa = 1.0 + static_cast<double>(seed >> 8) / 16777216.0;
+            double x = std::ldexp(i % 2 ? mantissa : -mantissa, i % 121 - 60);
+            powers.evaluate(&x, program_out.data());
+            for (int n = 0; n <= MAX_INT_POWER_EXPONENT; n++) {
+                double expected = std::pow(x, n);
+                double tree = IntPowerNode(std::make_unique<NumberNode>(x), n).evaluate();
+                worst = std::max({worst, ulpDistance(tree, expected), ulpDistance(program_out[n], expected)});
+            }
+        }
+        allPassed &= report("int power max ulp vs pow <= 2", 1.0, worst <= 2 ? 1.0 : 0.0);
+    } catch (const std::exception& e) {
+        reportError("strength reduction", e);
+        allPassed = false;
+    }
+    
+    return allPassed;
+}
+
+// 公式组测试：共享子表达式、单行与批量结果一致
+bool testFormulaBundle() {
+    bool allPassed = true;
+    std::cout << "\nFormula Bundle Tests:" << std::endl;
+    std::cout << "====================================" << std::endl;
+    
+    try {
+        FormulaBundle bundle({"price * qty", "price * qty * (1 - disc)", "(price * qty)^2 + 1"});
+        std::vector<double> row = bundle.evaluate({10.0, 3.0, 0.25});
+        allPassed &= report("bundle[0] price * qty", 30.0, row[0]);
+        allPassed &= report("bundle[1] price * qty * (1 - disc)", 22.5, row[1]);
+        allPassed &= report("bundle[2] (price * qty)^2 + 1", 901.0, row[2]);
+        allPassed &= report("bundle variables", 3.0, static_cast<double>(bundle.variables().size()));
+        // price * qty 在三个公式中只编译一次：3 个输入、常量 1、price * qty、
+        // 1 - disc、乘 (1 - disc)、平方、加 1 共 9 条指令，后两个公式各复用一次 price * qty
+        allPassed &= report("bundle instruction count", 9.0, static_cast<double>(bundle.instructionCount()));
+        allPassed &= report("bundle shared subexpressions", 2.0, static_cast<double>(bundle.sharedSubexpressions()));
+        
+        // 只共享输入时没有共享的计算
+        FormulaBundle unshared({"x + y", "x * y"});
+        allPassed &= report("bundle inputs only shared", 0.0, static_cast<double>(unshared.sharedSubexpressions()));
+        
+        // 批量计算跨越多个块，结果应与单行计算一致
+        const size_t rows = 1000;
+        std::vector<double> price(rows), qty(rows), disc(rows);
+        for (size_t i = 0; i < rows; i++) {
+            price[i] = 1.0 + i * 0.5;
+            qty[i] = static_cast<double>(i % 7);
+            disc[i] = (i % 4) * 0.1;
+        }
+        std::vector<std::vector<double>> out(3, std::vector<double>(rows));
+        const double* inputs[] = {price.data(), qty.data(), disc.data()};
+        double* outputs[] = {out[0].data(), out[1].data(), out[2].data()};
+        bundle.evaluateBatch(inputs, rows, outputs);
+        
+        double max_diff = 0.0;
+        for (size_t i = 0; i < rows; i++) {
+            std::vector<double> expected = bundle.evaluate({price[i], qty[i], disc[i]});
+            for (size_t j = 0; j < 3; j++) {
+                max_diff = std::max(max_diff, std::abs(expected[j] - out[j][i]));
+            }
+        }
+        allPassed &= report("bundle batch vs scalar max diff", 0.0, max_diff);
+        
+        // 分段公式：批量计算使用无分支选择
+        FormulaBundle piecewise({"x < 0 ? 0 : x > 1 ? 1 : x",
+                                 "if(x < 0.3, x * 0.1, if(x < 0.6, x * 0.2, x * 0.3))"});
+        std::vector<double> xs(rows), clamp(rows), tier(rows);
+        for (size_t i = 0; i < rows; i++) {
+            xs[i] = std::sin(static_cast<double>(i)) * 1.5;
+        }
+        const double* x_column[] = {xs.data()};
+        double* piecewise_out[] = {clamp.data(), tier.data()};
+        piecewise.evaluateBatch(x_column, rows, piecewise_out);
+        double piecewise_diff = 0.0;
+        for (size_t i = 0; i < rows; i++) {
+            double x = xs[i];
+            double expected_clamp = x < 0 ? 0 : (x > 1 ? 1 : x);
+            double expected_tier = x < 0.3 ? x * 0.1 : (x < 0.6 ? x * 0.2 : x * 0.3);
+            piecewise_diff = std::max(piecewise_diff, std::abs(clamp[i] - expected_clamp));
+            piecewise_diff = std::max(piecewise_diff, std::abs(tier[i] - expected_tier));
+        }
+        allPassed &= report("piecewise batch max diff", 0.0, piecewise_diff);
+        
+        // 指定输入顺序
+        FormulaBundle ordered({"x - y"}, {"y", "x"});
+        allPassed &= report("ordered bundle x - y (y=1, x=5)", 4.0, ordered.evaluate({1.0, 5.0})[0]);
+    } catch (const std::exception& e) {
+        reportError("formula bundle", e);
+        allPassed = false;
+    }
+    
+    // 未声明的变量应报错
+    try {
+        FormulaBundle invalid({"x + z"}, {"x"});
+        std::cout << "Expression: undeclared variable z" << std::endl;
+        std::cout << "Status: FAIL (no error)" << std::endl;
+        allPassed = false;
+    } catch (const CalculatorException&) {
+        std::cout << "Expression: undeclared variable z" << std::endl;
+        std::cout << "Status: PASS" << std::endl;
+    }
+    std::cout << "--------------------" << std::endl;
+    
+    return allPassed;
+}
+
+// 列数据流测试：CSV 与二进制输入在多个块上逐行计算
+bool testColumnStream() {
+    bool allPassed = true;
+    std::cout << "\nColumn Stream Tests:" << std::endl;
+    std::cout << "====================================" << std::endl;
+    
+    try {
+        std::istringstream csv("price, qty, disc\n10,3,0.25\n2.5, 4 ,0\n\n1,1,1\n");
+        CsvColumnSource source(csv);
+        std::ostringstream out;
+        // 块大小为 2，强制跨块
+        size_t rows = evaluateColumns("price * qty * (1 - disc)", source, out, ColumnOutputFormat::TEXT, 2);
+        allPassed &= report("csv rows", 3.0, static_cast<double>(rows));
+        allPassed &= report("csv output matches", 1.0, out.str() == "22.5\n10\n0\n" ? 1.0 : 0.0);
+        
+        const double records[] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+        std::istringstream bin(std::string(reinterpret_cast<const char*>(records), sizeof(records)));
+        BinaryColumnSource binary(bin, {"a", "b"});
+        std::ostringstream bin_out;
+        evaluateColumns("b - a^2", binary, bin_out, ColumnOutputFormat::BINARY, 2);
+        std::string bytes = bin_out.str();
+        double last = 0.0;
+        if (bytes.size() == 3 * sizeof(double)) {
+            std::memcpy(&last, bytes.data() + 2 * sizeof(double), sizeof(double));
+        }
+        allPassed &= report("binary b - a^2 (last row)", -19.0, last);
+        
+        // 归约名只在后跟 '(' 时是关键字，可以作为列名
+        std::istringstream named("min,max\n1,4\n2,7\n");
+        CsvColumnSource named_source(named);
+        std::ostringstream named_out;
+        evaluateColumns("max - min + max(i, 1, 3, i)", named_source, named_out, ColumnOutputFormat::TEXT);
+        allPassed &= report("csv columns named min/max", 1.0, named_out.str() == "6\n8\n" ? 1.0 : 0.0);
+    } catch (const std::exception& e) {
+        reportError("column stream", e);
+        allPassed = false;
+    }
+    
+    // 超过上限的块大小在分配缓冲之前被拒绝
+    try {
+        std::istringstream csv("x\n1\n");
+        CsvColumnSource source(csv);
+        std::ostringstream out;
+        evaluateColumns("x", source, out, ColumnOutputFormat::TEXT, MAX_COLUMN_CHUNK_ROWS + 1);
+        std::cout << "Expression: reject oversized chunk" << std::endl;
+        std::cout << "Status: FAIL (no error)" << std::endl;
+        allPassed = false;
+    } catch (const std::exception&) {
+        std::cout << "Expression: reject oversized chunk" << std::endl;
+        std::cout << "Status: PASS" << std::endl;
+    }
+    std::cout << "--------------------" << std::endl;
+    
+    return allPassed;
+}
+
+// 剖析测试：调用次数、惰性分支与 JSON 输出
+bool testProfiler() {
+    bool allPassed = true;
+    std::cout << "\nProfiler Tests:" << std::endl;
+    std::cout << "====================================" << std::endl;
+    
+    try {
+        Calculator calculator;
+        ProfileReport profile = calculator.profile("1 ? sin(2) * 3 : 1 / 0", 10);
+        allPassed &= report("profile result", std::sin(2.0) * 3, profile.result);
+        allPassed &= report("profile root calls", 10.0, static_cast<double>(profile.root.calls));
+        allPassed &= report("profile children", 3.0, static_cast<double>(profile.root.children.size()));
+        // 未选中的分支不被求值
+        allPassed &= report("profile untaken branch calls", 0.0,
+                            static_cast<double>(profile.root.children[2].calls));
+        allPassed &= report("profile self <= total", 1.0,
+                            profile.root.self_cycles <= profile.root.cycles ? 1.0 : 0.0);
+        std::string json = profile.toJson();
+        allPassed &= report("profile json tree", 1.0,
+                            json.find("\"node\":\"FunctionNode(sin)\"") != std::string::npos ? 1.0 : 0.0);
+        allPassed &= report("profile text tree", 1.0,
+                            profile.toText().find("ConditionalNode") != std::string::npos ? 1.0 : 0.0);
+        allPassed &= report("profile double path", 1.0, profile.path == "double" ? 1.0 : 0.0);
+        
+        // 整数表达式与普通求值一样走 int64 路径
+        ProfileReport integer = calculator.profile("2^10 - 3 * 4", 10);
+        allPassed &= report("profile int64 path result", 1012.0, integer.result);
+        allPassed &= report("profile int64 path", 1.0, integer.path == "int64" ? 1.0 : 0.0);
+        allPassed &= report("profile int64 path calls", 10.0, static_cast<double>(integer.root.calls));
+        
+        // int64 溢出回退到 double 时，只统计 double 路径的调用
+        ProfileReport fallback = calculator.profile("10^400 + 1", 1000);
+        allPassed &= report("profile fallback path", 1.0, fallback.path == "double" ? 1.0 : 0.0);
+        allPassed &= report("profile fallback root calls", 1000.0, static_cast<double>(fallback.root.calls));
+        allPassed &= report("profile fallback leaf calls", 1000.0,
+                            static_cast<double>(fallback.root.children[1].calls));
+        
+        // 归约体由编译后的程序计算，报告中标记为未计时
+        ProfileReport reduction = calculator.profile("sum(i, 1, 10, i^2)", 5);
+        allPassed &= report("profile reduction calls", 5.0, static_cast<double>(reduction.root.calls));
+        allPassed &= report("profile reduction body not measured", 0.0,
+                            reduction.root.children[2].measured ? 1.0 : 0.0);
+        allPassed &= report("profile reduction body marked", 1.0,
+                            reduction.toText().find("not measured") != std::string::npos &&
+                            reduction.toJson().find("\"measured\":false") != std::string::npos ? 1.0 : 0.0);
+        
+        // 非有限结果在 JSON 中输出为 null
+        std::string overflow = calculator.profile("10^400", 1).toJson();
+        allPassed &= report("profile json non-finite result", 1.0,
+                            overflow.find("\"result\":null") != std::string::npos ? 1.0 : 0.0);
+    } catch (const std::exception& e) {
+        reportError("profiler", e);
+        allPassed = false;
+    }
+    
+    return allPassed;
+}
+
+// 词法分析测试：令牌文本直接引用输入，拼接后与去掉空白的输入一致
+bool testLexerText() {
+    bool allPassed = true;
+    std::cout << "\nLexer Text Tests:" << std::endl;
+    std::cout << "====================================" << std::endl;
+    
+    const std::vector<std::string> pieces = {"0", "12", "3.25", ".5", "7.", "x", "x_1", "abc", "Rate2",
+                                             "sqrt", "sin", "if", "+", "-", "*", "/", "^", "(", ")",
+                                             "<", "<=", ">", ">=", "==", "!=", "&&", "||", "?", ":", ","};
+    const std::string spaces = " \t\n\r\v\f";
+    unsigned int seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return seed >> 16;
+    };
+    size_t mismatches = 0;
+    size_t errors = 0;
+    size_t invalid_rejected = 0;
+    for (int round = 0; round < 200; round++) {
+        std::string input;
+        while (input.size() < 200 + static_cast<size_t>(round * 37) % 700) {
+            input += pieces[next() % pieces.size()];
+            for (unsigned int k = next() % 6; k > 0; k--) {
+                input += spaces[next() % spaces.size()];
+            }
+        }
+        if (round % 10 == 0) {
+            input[input.size() / 2] = '#';  // 无效字符
+        }
+        
+        try {
+            Lexer lexer(input);
+            std::string joined;
+            for (const Token& token : lexer.tokenize()) {
+                joined += token.text;
+                if (token.type == TokenType::NUMBER && token.value != std::stod(std::string(token.text))) {
+                    mismatches++;
+                }
+            }
+            std::string compact;
+            for (char ch : input) {
+                if (spaces.find(ch) == std::string::npos) {
+                    compact += ch;
+                }
+            }
+            if (joined != compact) {
+                mismatches++;
+            }
+        } catch (const std::exception&) {
+            // 相邻的数字片段可能拼出多个小数点
+            errors++;
+            if (round % 10 == 0) {
+                invalid_rejected++;
+            }
+        }
+    }
+    std::cout << "Random inputs with lexer errors: " << errors << "/200" << std::endl;
+    allPassed &= report("random input token text mismatches", 0.0, static_cast<double>(mismatches));
+    allPassed &= report("inputs with invalid character rejected", 20.0, static_cast<double>(invalid_rejected));
+    
+    // 解析器在 Lexer 存活期间复制变量名，长表达式结果正确
+    Calculator calculator;
+    std::string sum = "1";
+    for (int i = 0; i < 200; i++) {
+        sum += " + 1";
+    }
+    allPassed &= report("long expression value", 201.0, calculator.evaluate(sum));
+    
+    return allPassed;
+}
+
+// 归约测试：结果与线程数无关、补偿求和精度、外层变量
+bool testReductions() {
+    bool allPassed = true;
+    std::cout << "\nReduction Tests:" << std::endl;
+    std::cout << "====================================" << std::endl;
+    
+    try {
+        Calculator calculator;
+        const std::string harmonic = "sum(i, 1, 1000000, 1 / i)";
+        double reference = 0.0;
+        bool deterministic = true;
+        for (unsigned int threads : {1u, 2u, 3u, 8u}) {
+            setReductionThreads(threads);
+            calculator.clearCache();
+            double value = calculator.evaluate(harmonic);
+            if (threads == 1) {
+                reference = value;
+            } else if (value != reference) {
+                deterministic = false;
+            }
+        }
+        setReductionThreads(0);
+        allPassed &= report("sum identical across thread counts", 1.0, deterministic ? 1.0 : 0.0);
+        // H(10^6) = 14.392726722865723631...，补偿求和误差应在 1e-13 以内
+        allPassed &= report("harmonic sum error < 1e-13", 1.0,
+                            std::abs(reference - 14.392726722865723631) < 1e-13 ? 1.0 : 0.0);
+        
+        // 归约体引用外层输入变量
+        FormulaBundle bundle({"sum(i, 1, n, i * x)", "max(i, 0, n, 0 - (i - x)^2)"});
+        std::vector<double> row = bundle.evaluate({10.0, 0.5});
+        allPassed &= report("bundle sum(i, 1, n, i * x)", 27.5, row[0]);
+        allPassed &= report("bundle max(i, 0, n, -(i - x)^2)", -0.25, row[1]);
+    } catch (const std::exception& e) {
+        reportError("reductions", e);
+        allPassed = false;
+    }
+    
+    // 树求值路径中，归约体的除零与定义域错误与普通表达式一样抛出异常
+    std::vector<std::pair<std::string, std::string>> error_cases = {
+        {"sum(i, 0, 3, 1 / i)", "除零错误"},
+        {"sum(i, 1, 3, log(0 - i))", "对数函数的参数必须为正数"},
+        {"max(i, 1, 3, sqrt(2 - i))", "负数不能开平方根"},
+        {"sum(i, 1, 3, sum(j, 0, i, 1 / j))", "除零错误"},  // 嵌套归约
+        {"sum(i, 1, 100000, 1 / (i - 90000))", "除零错误"}  // 多线程时出错项位于靠后的块
+    };
+    for (unsigned int threads : {1u, 4u}) {
+        setReductionThreads(threads);
+        Calculator calculator;
+        for (const auto& test : error_cases) {
+            std::string label = test.first + " [" + std::to_string(threads) + " threads]";
+            std::cout << "Expression: " << label << std::endl;
+            try {
+                calculator.evaluate(test.first);
+                std::cout << "Status: FAIL (no error)" << std::endl;
+                allPassed = false;
+            } catch (const CalculatorException& e) {
+                bool matched = std::string(e.what()).find(test.second) != std::string::npos;
+                std::cout << "Error: " << e.what() << std::endl;
+                std::cout << "Status: " << (matched ? "PASS" : "FAIL") << std::endl;
+                allPassed &= matched;
+            }
+            std::cout << "--------------------" << std::endl;
+        }
+    }
+    setReductionThreads(0);
+    
+    // 只有实际求值的分支会报错
+    try {
+        Calculator calculator;
+        allPassed &= report("sum(i, 0, 3, i == 0 ? 0 : 1 / i)", 11.0 / 6.0,
+                            calculator.evaluate("sum(i, 0, 3, i == 0 ? 0 : 1 / i)"));
+        allPassed &= report("sum(i, 0, 3, i == 0 || 1 / i > 0)", 4.0,
+                            calculator.evaluate("sum(i, 0, 3, i == 0 || 1 / i > 0)"));
+    } catch (const std::exception& e) {
+        reportError("reduction untaken branch", e);
+        allPassed = false;
+    }
+    
+    return allPassed;
+}
+
+// 逼近测试：误差界、区间外回退、未知变量报错
+bool testApproximation() {
+    bool allPassed = true;
+    std::cout << "\nApproximation Tests:" << std::endl;
+    std::cout << "====================================" << std::endl;
+    
+    try {
+        Calculator calculator;
+        const double tolerance = 1e-9;
+        Approximation approx = calculator.approximate("exp(sin(x)) * log(1 + x)", "x", 0.0, 10.0, tolerance);
+        allPassed &= report("approximation meets tolerance", 1.0, approx.meetsTolerance() ? 1.0 : 0.0);
+        // 满足容差的候选中系数最少的是 12 次 x 8 段
+        allPassed &= report("approximation coefficient count", 104.0, static_cast<double>(approx.coefficientCount()));
+        
+        // 在不同于校验网格的点上检查误差
+        double max_error = 0.0;
+        for (int i = 0; i <= 9973; i++) {
+            double x = 10.0 * i / 9973.0;
+            max_error = std::max(max_error, std::abs(approx(x) - std::exp(std::sin(x)) * std::log(1 + x)));
+        }
+        allPassed &= report("approximation error < 2 * tolerance", 1.0, max_error < 2 * tolerance ? 1.0 : 0.0);
+        
+        // 区间外回退到精确计算
+        allPassed &= report("approximation out of range", std::exp(std::sin(25.0)) * std::log(26.0), approx(25.0));
+        
+        // 多项式在单段内即可精确表示
+        Approximation cubic = calculator.approximate("x^3 - 2 * x", "x", -1.0, 1.0, 1e-12);
+        allPassed &= report("cubic coefficient count", 5.0, static_cast<double>(cubic.coefficientCount()));
+        allPassed &= report("cubic at 0.5", -0.875, cubic(0.5));
+    } catch (const std::exception& e) {
+        reportError("approximation", e);
+        allPassed = false;
+    }
+    
+    // 自变量以外的变量应报错
+    try {
+        Calculator calculator;
+        calculator.approximate("x + y", "x", 0.0, 1.0, 1e-6);
+        std::cout << "Expression: approximate free variable y" << std::endl;
+        std::cout << "Status: FAIL (no error)" << std::endl;
+        allPassed = false;
+    } catch (const CalculatorException&) {
+        std::cout << "Expression: approximate free variable y" << std::endl;
+        std::cout << "Status: PASS" << std::endl;
+    }
+    std::cout << "--------------------" << std::endl;
+    
+    return allPassed;
+}
+
+// 持久缓存测试：跨映射可见、程序序列化往返、淘汰与并发写入
+bool testPersistentCache() {
+    bool allPassed = true;
+    std::cout << "\nPersistent Cache Tests:" << std::endl;
+    std::cout << "====================================" << std::endl;
+    
+#ifndef _WIN32
+    const std::string path = "test_persistent_cache.bin";
+    std::remove(path.c_str());
+    try {
+        PersistentCache writer(path, PersistentCache::MIN_CAPACITY);
+        writer.storeResult("2 + 3 * 4", 14.0);
+        ProgramBuilder builder;
+        builder.addOutput(compileExpression(builder, "sum(i, 1, n, i * x) + x^2"));
+        writer.storeProgram("sum(i, 1, n, i * x) + x^2", builder.build());
+        
+        // 第二个映射模拟另一个进程
+        PersistentCache reader(path);
+        double value = 0.0;
+        allPassed &= report("cache result hit", 14.0, reader.lookupResult("2 + 3 * 4", value) ? value : -1.0);
+        allPassed &= report("cache result miss", 0.0, reader.lookupResult("2 + 3 * 5", value) ? 1.0 : 0.0);
+        auto program = reader.lookupProgram("sum(i, 1, n, i * x) + x^2");
+        double inputs[] = {10.0, 0.5};  // 变量按首次出现的顺序：n, x
+        double output = 0.0;
+        if (program) {
+            program->evaluate(inputs, &output);
+        }
+        allPassed &= report("cache program round trip", 27.75, output);
+        
+        // 写入远超容量的记录后，最早的记录被淘汰，最新的记录仍然可用
+        for (int i = 0; i < 20000; i++) {
+            writer.storeResult("filler " + std::to_string(i), i);
+        }
+        allPassed &= report("cache oldest evicted", 0.0, reader.lookupResult("2 + 3 * 4", value) ? 1.0 : 0.0);
+        allPassed &= report("cache newest kept", 19999.0, reader.lookupResult("filler 19999", value) ? value : -1.0);
+        
+        // 多个映射并发写入与读取：命中的结果必须正确
+        bool consistent = true;
+        std::vector<std::thread> workers;
+        std::vector<char> ok(4, 1);
+        for (int t = 0; t < 4; t++) {
+            workers.emplace_back([&path, &ok, t]() {
+                PersistentCache cache(path);
+                for (int i = 0; i < 5000; i++) {
+                    std::string key = "k" + std::to_string((i * 7 + t) % 3000);
+                    double got = 0.0;
+                    if (cache.lookupResult(key, got) && got != std::stod(key.substr(1))) {
+                        ok[t] = 0;
+                    }
+                    cache.storeResult(key, std::stod(key.substr(1)));
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (char flag : ok) {
+            consistent = consistent && flag;
+        }
+        allPassed &= report("cache concurrent hits consistent", 1.0, consistent ? 1.0 : 0.0);
+    } catch (const std::exception& e) {
+        reportError("persistent cache", e);
+        allPassed = false;
+    }
+    std::remove(path.c_str());
+    
+    // 非缓存文件应被拒绝
+    {
+        std::ofstream other(path);
+        other << std::string(PersistentCache::MIN_CAPACITY, 'x');
+    }
+    try {
+        PersistentCache invalid(path);
+        std::cout << "Expression: reject non-cache file" << std::endl;
+        std::cout << "Status: FAIL (no error)" << std::endl;
+        allPassed = false;
+    } catch (const std::exception&) {
+        std::cout << "Expression: reject non-cache file" << std::endl;
+        std::cout << "Status: PASS" << std::endl;
+    }
+    std::cout << "--------------------" << std::endl;
+    std::remove(path.c_str());
+#endif
+    
+    return allPassed;
+}
 
 int main() {
     Calculator calculator;
@@ -23,7 +622,41 @@ int main() {
         {"((2 + 3) * 4) / 2", 10.0},  // 嵌套括号
         {"0.5 + 0.5", 1.0},  // 小数精度
         {"-(-5)", 5.0},  // 双重负号
-        {"2 + -3", -1.0}  // 正负混合
+        {"2 + -3", -1.0},  // 正负混合
+        // 强度削减与整数快速路径
+        {"1.5^2", 2.25},  // 整数指数 -> 乘法链
+        {"2^-2", 0.25},  // 负整数指数
+        {"100000^-64 > 0", 1.0},  // 负指数使用 std::pow，结果为次正规数而不是 0
+        {"(0.5 + 1.5)^10", 1024.0},
+        {"16^0.5", 4.0},  // ^0.5 -> sqrt
+        {"(2 + 7)^0.5 * 2", 6.0},
+        {"10 / 4", 2.5},  // 除以 2 的幂 -> 乘以精确倒数
+        {"1 / 3 * 3", 1.0},  // 倒数不精确时保持除法
+        {"2^62 + 1 - 2^62", 1.0},  // int64 精确计算
+        {"3^39 - 3^39 + 7", 7.0},
+        {"3^40 - 3^40 + 1", 1.0},  // int64 溢出回退到 double
+        // 比较、逻辑与条件运算
+        {"3 < 5", 1.0},
+        {"2 + 1 >= 3", 1.0},
+        {"1 == 2", 0.0},
+        {"1 != 2", 1.0},
+        {"1 < 2 && 2 < 1", 0.0},
+        {"0 || 3", 1.0},
+        {"5 > 3 ? 10 : 20", 10.0},
+        {"if(2 > 3, 1, 2)", 2.0},
+        {"1 ? 2 : 0 ? 3 : 4", 2.0},  // 条件运算右结合
+        {"2.5 < 3 ? 0.5 : 1", 0.5},
+        {"0 ? 1 / 0 : 7", 7.0},  // 未选中的分支不计算
+        {"1 || 1 / 0", 1.0},  // 短路求值
+        {"0 && 1 / 0", 0.0},
+        // 区间归约
+        {"sum(i, 1, 100, i)", 5050.0},
+        {"prod(k, 1, 5, k)", 120.0},
+        {"min(i, -3, 3, i^2)", 0.0},
+        {"max(i, 1, 10, i > 5 ? 10 - i : i)", 5.0},
+        {"sum(i, 1, 10, sum(j, 1, i, 1))", 55.0},  // 嵌套归约
+        {"sum(i, 5, 4, i)", 0.0},  // 空区间
+        {"sum(i, 1, 1000000, 1 / i^2)", 1.6449330668}
     };
     
     std::cout << "Expression Calculator Test Results:" << std::endl;
@@ -34,26 +667,40 @@ int main() {
     for (const auto& test : test_cases) {
         try {
             double result = calculator.evaluate(test.first);
-            bool passed = std::abs(result - test.second) < 0.001;
-            
-            std::cout << "Expression: " << test.first << std::endl;
-            std::cout << "Expected: " << test.second << std::endl;
-            std::cout << "Got: " << result << std::endl;
-            std::cout << "Status: " << (passed ? "PASS" : "FAIL") << std::endl;
-            std::cout << "--------------------" << std::endl;
-            
-            if (!passed) {
+            if (!report(test.first, test.second, result)) {
                 allPassed = false;
             }
         } catch (const std::exception& e) {
-            std::cout << "Expression: " << test.first << std::endl;
-            std::cout << "Error: " << e.what() << std::endl;
-            std::cout << "Status: FAIL" << std::endl;
-            std::cout << "--------------------" << std::endl;
+            reportError(test.first, e);
             allPassed = false;
         }
     }
     
+    if (!testStrengthReduction()) {
+        allPassed = false;
+    }
+    if (!testFormulaBundle()) {
+        allPassed = false;
+    }
+    if (!testColumnStream()) {
+        allPassed = false;
+    }
+    if (!testProfiler()) {
+        allPassed = false;
+    }
+    if (!testLexerText()) {
+        allPassed = false;
+    }
+    if (!testReductions()) {
+        allPassed = false;
+    }
+    if (!testApproximation()) {
+        allPassed = false;
+    }
+    if (!testPersistentCache()) {
+        allPassed = false;
+    }
+    
     std::cout << "\nOverall Result: " << (allPassed ? "ALL TESTS PASSED" : "SOME TESTS FAILED") << std::endl;
     
     return allPassed ? 0 : 1;